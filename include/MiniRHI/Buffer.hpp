@@ -17,12 +17,34 @@ namespace minirhi {
 		eVertex,
 		eIndex,
 		eConstant,
+		eIndirect,
 		eCount
 	};
 
+	// Layout of a single glDrawElementsIndirect command.
+	struct DrawIndexedIndirectCommand {
+		u32 index_count;
+		u32 instance_count;
+		u32 first_index;
+		i32 base_vertex;
+		u32 base_instance;
+	};
+	static_assert(sizeof(DrawIndexedIndirectCommand) == 5 * sizeof(u32));
+
 	template<typename T>
 	concept TVtxElem = TIsVertex<T>;
 
+	template<typename T>
+	concept TIndexElem = std::same_as<T, u16> || std::same_as<T, u32>;
+
+	enum class IndexType {
+		eUInt16,
+		eUInt32,
+	};
+
+	template<TIndexElem Idx>
+	inline constexpr IndexType kIndexType = std::same_as<Idx, u16> ? IndexType::eUInt16 : IndexType::eUInt32;
+
 	u32 get_buffer_type(BufferType bufferType) noexcept;
 
 	namespace detail {
@@ -39,8 +61,8 @@ namespace minirhi {
 
 		template<typename Elem>
 		struct BufferConstraints<BufferType::eIndex, Elem> {
-			static constexpr bool kSatisfied = std::same_as<Elem, u32>;
-			static_assert(kSatisfied, "For minirhi::BufferDesc<Type, Elem> with [Type = BufferType::eIndex] Elem must be u32 integral type!");
+			static constexpr bool kSatisfied = TIndexElem<Elem>;
+			static_assert(kSatisfied, "For minirhi::BufferDesc<Type, Elem> with [Type = BufferType::eIndex] Elem must be u16 or u32 integral type!");
 		};
 
 		template<typename Elem>
@@ -48,6 +70,12 @@ namespace minirhi {
 			static constexpr bool kSatisfied = std::same_as<Elem, u8>;
 			static_assert(kSatisfied, "For minirhi::BufferDesc<Type, Elem> with [Type = BufferType::eConstant] Elem must be u8 integral type!");
 		};
+
+		template<typename Elem>
+		struct BufferConstraints<BufferType::eIndirect, Elem> {
+			static constexpr bool kSatisfied = std::same_as<Elem, DrawIndexedIndirectCommand>;
+			static_assert(kSatisfied, "For minirhi::BufferDesc<Type, Elem> with [Type = BufferType::eIndirect] Elem must be minirhi::DrawIndexedIndirectCommand!");
+		};
 	}
 
 	template<BufferType Type, typename Elem>
@@ -84,6 +112,7 @@ namespace minirhi {
 	namespace detail {
 		u32 create_buffer_(BufferType type, std::size_t size_in_bytes, const void* data) noexcept;
 		void destroy_buffer_(u32& handle) noexcept;
+		void update_buffer_(u32 handle, std::size_t offset, std::size_t size_in_bytes, const void* data) noexcept;
 	}
 
 	inline static constexpr u32 kBufferInvalidHandle = std::numeric_limits<u32>::max();
@@ -102,12 +131,20 @@ namespace minirhi {
 		    : handle(detail::create_buffer_(Type, buffer_desc.size_bytes(), std::bit_cast<const void*>(buffer_desc.data())))
 			, desc(buffer_desc)
 		{}	
+
+		// Overwrites elements starting at first, the buffer keeps its size.
+		void update(std::span<const Elem> data, std::size_t first = 0) const noexcept {
+			assert(first + data.size() <= desc.element_count());
+			detail::update_buffer_(handle, first * sizeof(Elem), data.size_bytes(), std::bit_cast<const void*>(data.data()));
+		}
 	};
 
 	template<TVtxElem Elem>
 	using VertexBufferDesc = BufferDesc<BufferType::eVertex, Elem>;
-	using IndexBufferDesc = BufferDesc<BufferType::eIndex, u32>;
+	template<TIndexElem Idx = u32>
+	using IndexBufferDesc = BufferDesc<BufferType::eIndex, Idx>;
 	using ConstantBufferDesc = BufferDesc<BufferType::eConstant, u8>;
+	using IndirectBufferDesc = BufferDesc<BufferType::eIndirect, DrawIndexedIndirectCommand>;
 
 	template<TVtxElem Elem>
 	struct VertexBuffer final : BufferStorage<BufferType::eVertex, Elem> {
@@ -118,11 +155,12 @@ namespace minirhi {
 		{}
 	};
 
-	struct IndexBuffer final : BufferStorage<BufferType::eIndex, u32> {
+	template<TIndexElem Idx = u32>
+	struct IndexBuffer final : BufferStorage<BufferType::eIndex, Idx> {
 		explicit IndexBuffer() noexcept = default;
 
-		explicit IndexBuffer(std::span<const u32> indices) noexcept 
-			: BufferStorage<BufferType::eIndex, u32>{ IndexBufferDesc{ indices } }
+		explicit IndexBuffer(std::span<const Idx> indices) noexcept 
+			: BufferStorage<BufferType::eIndex, Idx>{ IndexBufferDesc<Idx>{ indices } }
 		{}
 	};
 
@@ -134,13 +172,47 @@ namespace minirhi {
 		{}
 	};
 
+	struct IndirectBuffer final : BufferStorage<BufferType::eIndirect, DrawIndexedIndirectCommand> {
+		explicit IndirectBuffer() noexcept = default;
+
+		explicit IndirectBuffer(std::span<const DrawIndexedIndirectCommand> commands) noexcept 
+			: BufferStorage<BufferType::eIndirect, DrawIndexedIndirectCommand>{ IndirectBufferDesc{ commands } }
+		{}
+	};
+
+	/*
+	* Non-owning range of a buffer, e.g. a slice of a StreamBuffer.
+	* offset is in bytes from the start of the buffer, count is in elements.
+	*/
+	template<BufferType Type, typename Elem>
+	struct BufferView {
+		static_assert(detail::BufferConstraints<Type, Elem>::kSatisfied, "Error! minirhi::BufferView constraints are not satisfied!");
+
+		u32 handle = kBufferInvalidHandle;
+		std::size_t offset = 0;
+		std::size_t count = 0;
+
+		[[nodiscard]]
+		bool is_valid() const noexcept {
+			return handle != kBufferInvalidHandle;
+		}
+	};
+
+	template<TVtxElem Elem>
+	using VertexBufferView = BufferView<BufferType::eVertex, Elem>;
+	template<TIndexElem Idx = u32>
+	using IndexBufferView = BufferView<BufferType::eIndex, Idx>;
+	using ConstantBufferView = BufferView<BufferType::eConstant, u8>;
+
 	template<BufferType Type, typename Elem>
 	using BufferRC = RC<BufferStorage<Type, Elem>>;
 
 	template<TVtxElem Elem>
 	using VertexBufferRC = RC<VertexBuffer<Elem>>;
-	using IndexBufferRC = RC<IndexBuffer>;
+	template<TIndexElem Idx = u32>
+	using IndexBufferRC = RC<IndexBuffer<Idx>>;
 	using ConstantBufferRC = RC<ConstantBuffer>;
+	using IndirectBufferRC = RC<IndirectBuffer>;
 
 	template<BufferType Type, typename Elem>
 	[[nodiscard]]
@@ -154,13 +226,37 @@ namespace minirhi {
 		return VertexBufferRC<Elem>{ vertices };
 	}
 
+	template<TIndexElem Idx>
 	[[nodiscard]]
-	inline IndexBufferRC make_index_buffer_rc(std::span<const u32> indices) noexcept {
-		return IndexBufferRC{ indices };
+	IndexBufferRC<Idx> make_index_buffer_rc(std::span<const Idx> indices) noexcept {
+		return IndexBufferRC<Idx>{ indices };
 	}
 
 	[[nodiscard]]
 	inline ConstantBufferRC make_constant_buffer_rc(std::span<const u8> constants) noexcept {
 		return ConstantBufferRC{ constants };
 	}
+
+	// Constant buffer holding a copy of value, e.g. the data of a UniformBlockSlot.
+	template<typename T> 
+		requires std::is_trivially_copyable_v<T> && (!std::convertible_to<const T&, std::span<const u8>>)
+	[[nodiscard]]
+	ConstantBufferRC make_constant_buffer_rc(const T& value) noexcept {
+		return ConstantBufferRC{ std::span<const u8>(std::bit_cast<const u8*>(&value), sizeof(T)) };
+	}
+
+	[[nodiscard]]
+	inline UniformBufferRange get_uniform_buffer_range(const ConstantBufferView& view) noexcept {
+		return UniformBufferRange{ view.handle, view.offset, view.count };
+	}
+
+	[[nodiscard]]
+	inline UniformBufferRange get_uniform_buffer_range(const ConstantBufferRC& buffer) noexcept {
+		return UniformBufferRange{ buffer.get().handle, 0, buffer.get().desc.size_bytes() };
+	}
+
+	[[nodiscard]]
+	inline IndirectBufferRC make_indirect_buffer_rc(std::span<const DrawIndexedIndirectCommand> commands) noexcept {
+		return IndirectBufferRC{ commands };
+	}
 }
@@ -0,0 +1,174 @@
+#pragma once
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "MiniRHI/Buffer.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	inline static constexpr u32 kBufferHeapInvalidId = std::numeric_limits<u32>::max();
+
+	template<BufferType Type, typename Elem>
+	struct BufferHeapHandle {
+		u32 id = kBufferHeapInvalidId;
+		// Bumped every time the id is freed, so a stale handle can't alias a later allocation reusing the id.
+		u32 generation = 0;
+
+		[[nodiscard]]
+		bool is_valid() const noexcept {
+			return id != kBufferHeapInvalidId;
+		}
+	};
+
+	/*
+	* Untyped part of BufferHeap. Sub-allocates byte ranges out of large GL buffers ("pages")
+	* with a first-fit free list per page, neighbouring free ranges are coalesced on free.
+	* Allocations are referred to by id and generation, the (page, offset) pair behind an id may change on defragment().
+	*/
+	class BufferHeapBase {
+	public:
+		static constexpr std::size_t kDefaultPageSize = 4 * 1024 * 1024;
+
+		explicit BufferHeapBase() noexcept = default;
+		explicit BufferHeapBase(BufferType type, std::size_t page_size) noexcept;
+
+		BufferHeapBase(const BufferHeapBase&) = delete;
+		BufferHeapBase& operator=(const BufferHeapBase&) = delete;
+
+		BufferHeapBase(BufferHeapBase&& rhs) noexcept = default;
+		BufferHeapBase& operator=(BufferHeapBase&& rhs) noexcept;
+
+		~BufferHeapBase() noexcept;
+
+		/*
+		* Repacks all live allocations back to back into as few freshly allocated pages as they fit in,
+		* copying them with glCopyBufferSubData, then releases the old pages.
+		* Views obtained before defragmenting are invalidated, handles stay valid.
+		*/
+		void defragment() noexcept;
+
+		[[nodiscard]]
+		std::size_t page_count() const noexcept {
+			return pages_.size();
+		}
+
+		[[nodiscard]]
+		std::size_t used_bytes() const noexcept;
+
+	protected:
+		struct Range {
+			std::size_t offset;
+			std::size_t size;
+		};
+
+		struct Page {
+			u32 handle = kBufferInvalidHandle;
+			std::size_t size = 0;
+			std::vector<Range> free_ranges;
+		};
+
+		struct Block {
+			u32 page = 0;
+			std::size_t offset = 0;
+			std::size_t size = 0;
+			std::size_t alignment = 1;
+			u32 generation = 0;
+			bool live = false;
+		};
+
+		u32 allocate_(std::size_t size, std::size_t alignment, const void* data) noexcept;
+		void update_(u32 id, u32 generation, std::size_t offset, std::size_t size, const void* data) noexcept;
+		void free_(u32 id, u32 generation) noexcept;
+
+		[[nodiscard]]
+		bool is_live_(u32 id, u32 generation) const noexcept {
+			return id < blocks_.size() && blocks_[id].live && blocks_[id].generation == generation;
+		}
+
+		[[nodiscard]]
+		const Block& block_(u32 id, u32 generation) const noexcept {
+			assert(is_live_(id, generation) && "Stale or invalid BufferHeap handle!");
+			return blocks_[id];
+		}
+
+		[[nodiscard]]
+		u32 block_generation_(u32 id) const noexcept {
+			return blocks_[id].generation;
+		}
+
+		[[nodiscard]]
+		u32 page_handle_(u32 page) const noexcept {
+			return pages_[page].handle;
+		}
+
+	private:
+		bool allocate_in_page_(u32 page, std::size_t size, std::size_t alignment, Block& block) noexcept;
+		u32 add_page_(std::size_t size) noexcept;
+		void release_() noexcept;
+
+		// Rebinds the copy targets only when they change, defragment() copies many blocks between few buffers.
+		void copy_block_(u32 src, u32 dst, std::size_t src_offset, std::size_t dst_offset, std::size_t size, u32& bound_src, u32& bound_dst) noexcept;
+
+		BufferType type_ = BufferType::eVertex;
+		std::size_t page_size_ = kDefaultPageSize;
+		// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for constant buffers, so that every allocation can be bound with glBindBufferRange.
+		std::size_t min_alignment_ = 1;
+		std::vector<Page> pages_;
+		std::vector<Block> blocks_;
+		std::vector<u32> free_ids_;
+	};
+
+	/*
+	* Carves many small buffers of one type out of a few large GL buffers.
+	* Meshes allocated from the same page share their GL buffer, so draws through views of them
+	* hit the same cached VAO. Allocations of different element types may share a heap.
+	*/
+	template<BufferType Type>
+	class BufferHeap : public BufferHeapBase {
+	public:
+		explicit BufferHeap() noexcept = default;
+		explicit BufferHeap(std::size_t page_size) noexcept
+			: BufferHeapBase(Type, page_size)
+		{}
+
+		template<typename Elem>
+		[[nodiscard]]
+		BufferHeapHandle<Type, Elem> allocate(std::span<const Elem> data) noexcept {
+			static_assert(detail::BufferConstraints<Type, Elem>::kSatisfied, "Error! minirhi::BufferHeap constraints are not satisfied!");
+			const u32 id = allocate_(data.size_bytes(), sizeof(Elem), data.data());
+			return BufferHeapHandle<Type, Elem>{ id, block_generation_(id) };
+		}
+
+		template<typename Elem>
+		void update(BufferHeapHandle<Type, Elem> handle, std::span<const Elem> data, std::size_t first = 0) noexcept {
+			assert((first + data.size()) * sizeof(Elem) <= block_(handle.id, handle.generation).size);
+			update_(handle.id, handle.generation, first * sizeof(Elem), data.size_bytes(), data.data());
+		}
+
+		template<typename Elem>
+		void free(BufferHeapHandle<Type, Elem>& handle) noexcept {
+			free_(handle.id, handle.generation);
+			handle = BufferHeapHandle<Type, Elem>{};
+		}
+
+		// False once the allocation behind handle has been freed, even if its id was reused since.
+		template<typename Elem>
+		[[nodiscard]]
+		bool is_live(BufferHeapHandle<Type, Elem> handle) const noexcept {
+			return is_live_(handle.id, handle.generation);
+		}
+
+		template<typename Elem>
+		[[nodiscard]]
+		BufferView<Type, Elem> view(BufferHeapHandle<Type, Elem> handle) const noexcept {
+			const Block& block = block_(handle.id, handle.generation);
+			return BufferView<Type, Elem>{ page_handle_(block.page), block.offset, block.size / sizeof(Elem) };
+		}
+	};
+
+	using VertexBufferHeap = BufferHeap<BufferType::eVertex>;
+	using IndexBufferHeap = BufferHeap<BufferType::eIndex>;
+	using ConstantBufferHeap = BufferHeap<BufferType::eConstant>;
+}
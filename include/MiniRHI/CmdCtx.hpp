@@ -10,10 +10,15 @@
 #endif
 
 #include "MiniRHI/Buffer.hpp"
+#include "MiniRHI/Framebuffer.hpp"
 #include "MiniRHI/PipelineState.hpp"
+#include "MiniRHI/Std140.hpp"
+#include "MiniRHI/Trace.hpp"
+#include "MiniRHI/TransientUniformAllocator.hpp"
 #include "PipelineState.hpp"
 #include "Buffer.hpp"
 #include "Texture.hpp"
+#include "TypeInference.hpp"
 
 #include <array>
 
@@ -43,28 +48,86 @@ namespace minirhi
 	};
 
 	namespace detail {
+		// A user slot matches a pipeline slot of the same type, typed uniform blocks also match generated ones by name.
+		template<typename PipelineSlot, typename UserSlot>
+		struct SlotMatches_ {
+			static constexpr bool kValue = std::same_as<PipelineSlot, UserSlot>;
+		};
+
+		template<typename Body, typename T, typename Name>
+		struct SlotMatches_<Slot<UniformBlockLayout<Body>, Name>, Slot<UniformBlock<T>, Name>> {
+			static constexpr bool kValue = check_std140_layout<T, Body::kValue>();
+		};
+
+		template<typename Body, typename T, typename Name>
+		struct SlotMatches_<Slot<UniformBlockLayout<Body>, Name>, Slot<TransientUniformBlock<T>, Name>> {
+			static constexpr bool kValue = check_std140_layout<T, Body::kValue>();
+		};
+
+		template<typename PipelineSlot, typename... UserSlots>
+		inline constexpr bool kHasMatchingSlot = (SlotMatches_<PipelineSlot, UserSlots>::kValue || ...);
+
+		template<typename PipelineSlot, typename... UserSlots>
+		consteval std::size_t find_matching_slot_() noexcept {
+			constexpr std::array<bool, sizeof...(UserSlots)> kMatches = { SlotMatches_<PipelineSlot, UserSlots>::kValue... };
+			return std::size_t(std::ranges::find(kMatches, true) - kMatches.begin());
+		}
+
+		template<typename PipelineSlot, typename... UserSlots>
+		using MatchingSlot_ = std::tuple_element_t<find_matching_slot_<PipelineSlot, UserSlots...>(), std::tuple<UserSlots...>>;
+
 		template<typename UserBS, typename PipelineBS>
 		struct DoesUserBindingSetMatch;
 
 		template<typename... UserSlots, typename... PipelineSlots>
 		struct DoesUserBindingSetMatch<BindingSet<UserSlots...>, BindingSet<PipelineSlots...>> {
-			static constexpr bool kValue = (SameAsAny<PipelineSlots, UserSlots...> && ...);
+			static constexpr bool kValue = (kHasMatchingSlot<PipelineSlots, UserSlots...> && ...);
 		};
 	
 		static constexpr u32 kInvalidVAHandle = std::numeric_limits<u32>::max();
 
+		// Fixed function state setters, they don't update the pipeline shadow.
+		void set_depth_test_impl_(bool enable) noexcept;
+		void set_depth_mask_impl_(DepthMask mask) noexcept;
+		void set_depth_func_impl_(DepthFunc func) noexcept;
+		void set_cull_face_enabled_impl_(bool enable) noexcept;
+		void set_cull_face_impl_(CullFaceMode mode) noexcept;
+		void set_front_face_impl_(FrontFace front) noexcept;
+		void set_polygon_mode_impl_(PolygonMode mode) noexcept;
+		void set_line_smooth_impl_(bool enable) noexcept;
+
+		// Mirrors the normalisation of the pipeline shadow, except for the cull mode which depends on the previous state.
+		[[nodiscard]]
+		consteval GraphicsPipelineRaw normalize_static_pipeline_(GraphicsPipelineRaw pipeline) noexcept {
+			if (!bool(pipeline.state.enable_depth)) {
+				pipeline.state.depth_mask = u32(DepthMask::eAll);
+				pipeline.state.depth_fn = u32(DepthFunc::eLe);
+			}
+			return pipeline;
+		}
+
+		// 0 binds the default framebuffer
+		void bind_framebuffer_impl_(u32 framebuffer) noexcept;
+
 		void clear_color_buffer_impl_(f32 r, f32 g, f32 b, f32 a) noexcept;
 		void clear_depth_buffer_impl_() noexcept;
 		void clear_stencil_buffer_impl_() noexcept;
 
-		void unset_pipeline_impl_() noexcept;
-		void draw_impl_(PrimitiveTopologyType topology, u32 vb, size_t vertex_count, size_t offset) noexcept;
-		void draw_indexed_impl_(PrimitiveTopologyType topology, u32 vb, u32 ib, size_t index_count, size_t offset) noexcept;
+		void bind_vertex_input_(std::span<const VtxAttrData> attribs, u32 vb, u32 ib, u32 instance_vb) noexcept;
+		void draw_impl_(PrimitiveTopologyType topology, size_t vertex_count, size_t offset) noexcept;
+		void draw_indexed_impl_(PrimitiveTopologyType topology, IndexType index_type, size_t index_count, size_t offset) noexcept;
+		void draw_indexed_base_vertex_impl_(PrimitiveTopologyType topology, IndexType index_type, size_t index_count, size_t first_index, i32 base_vertex) noexcept;
+		void draw_instanced_impl_(PrimitiveTopologyType topology, size_t vertex_count, size_t instance_count, size_t offset) noexcept;
+		void draw_indexed_instanced_impl_(PrimitiveTopologyType topology, IndexType index_type, size_t index_count, size_t instance_count, size_t offset) noexcept;
+		void multi_draw_indexed_indirect_impl_(PrimitiveTopologyType topology, IndexType index_type, u32 indirect_buffer, size_t draw_count, size_t first_command) noexcept;
 	
-		void set_texture2d_binding_impl_(u32 bound_texture_count, u32 program, std::string_view name, u32 texture) noexcept;
-		void set_uint_binding_impl_(u32 program, std::string_view name, u32 value) noexcept;
-		void set_float_binding_impl_(u32 program, std::string_view name, f32 value) noexcept;
-		void set_mat4_binding_impl_(u32 program, std::string_view name, const glm::mat4& value) noexcept;
+		void bind_texture2d_impl_(u32 unit, u32 texture) noexcept;
+		void bind_uniform_buffer_impl_(u32 binding, const UniformBufferRange& range) noexcept;
+		void set_sampler_binding_impl_(u32 program, i32 location, u32 unit) noexcept;
+		void set_uint_binding_impl_(u32 program, i32 location, u32 value) noexcept;
+		void set_float_binding_impl_(u32 program, i32 location, f32 value) noexcept;
+		void set_mat4_binding_impl_(u32 program, i32 location, const glm::mat4& value) noexcept;
+		u64 get_uniform_epoch_(u32 program) noexcept;
 
 		void borrow_context_() noexcept;
 		void release_context_() noexcept;
@@ -74,16 +137,16 @@ namespace minirhi
 	class [[nodiscard]] DrawCtx {
 		friend class CmdCtx;
 	private:
-		static constexpr auto kAttrs = get_vtx_attr_array(Attrs{});
+		static constexpr const auto& kAttrs = kVtxAttrArray<Attrs>;
 
-		u32 vao_ = detail::kInvalidVAHandle;
 		u32 program_ = kShaderInvalidHandle;
 		PrimitiveTopologyType topology_ = PrimitiveTopologyType::eTriangle;
+		std::array<i32, BS::kSlotCount> locations_{};
 
-		DrawCtx(u32 vao, u32 program, PrimitiveTopologyType topology) noexcept 
-			: vao_(vao)
-			, program_(program)
+		DrawCtx(u32 program, PrimitiveTopologyType topology, const std::array<i32, BS::kSlotCount>& locations) noexcept 
+			: program_(program)
 			, topology_(topology)
+			, locations_(locations)
 		{}
 
 	public:
@@ -91,11 +154,10 @@ namespace minirhi
 		DrawCtx& operator=(const DrawCtx&) = delete;
 
 		DrawCtx(DrawCtx&& rhs) noexcept 
-			: vao_(rhs.vao_)
-			, program_(rhs.program_)
+			: program_(rhs.program_)
 			, topology_(rhs.topology_)
+			, locations_(rhs.locations_)
 		{
-			rhs.vao_ = detail::kInvalidVAHandle;
 			rhs.program_ = kShaderInvalidHandle;
 			rhs.topology_ = PrimitiveTopologyType::eCount;
 		}
@@ -105,11 +167,10 @@ namespace minirhi
 				return *this;
 			}
 
-			vao_ = rhs.vao_;
 			program_ = rhs.program_;
 			topology_ = rhs.topology_;
+			locations_ = rhs.locations_;
 
-			rhs.vao_ = detail::kInvalidVAHandle;
 			rhs.program_ = kShaderInvalidHandle;
 			rhs.topology_ = PrimitiveTopologyType::eCount;
 
@@ -123,30 +184,120 @@ namespace minirhi
 		template<typename... Slots>
 		void set_bindings(const BindingSet<Slots...>& bs) const noexcept {
 			static_assert(detail::DoesUserBindingSetMatch<BindingSet<Slots...>, BS>::kValue, "User-defined BindingSet does not match the pipeline's binding set!");
-			u32 bound_texture_count = 0;
-			(set_binding_(bs.template get_slot<Slots>(), bound_texture_count), ...);
+			static_assert(!BindingSet<Slots...>::kHasTransientSlots, "Binding sets with transient uniform blocks need a TransientUniformAllocator!");
+			set_bindings_(bs, ~u64(0), nullptr);
+		}
+
+		/*
+		* Only uploads the slots that were modified since the set was last applied to this program.
+		* Falls back to uploading every slot when the set was applied to another program 
+		* or something else has uploaded uniforms of this program in between.
+		* Uploads are additionally filtered against the per-program uniform shadow.
+		*/
+		template<typename... Slots>
+		void set_bindings(BindingSet<Slots...>& bs) const noexcept {
+			static_assert(detail::DoesUserBindingSetMatch<BindingSet<Slots...>, BS>::kValue, "User-defined BindingSet does not match the pipeline's binding set!");
+			static_assert(!BindingSet<Slots...>::kHasTransientSlots, "Binding sets with transient uniform blocks need a TransientUniformAllocator!");
+			set_tracked_bindings_(bs, nullptr);
+		}
+
+		/*
+		* Same as above, values of transient uniform block slots are copied into transient and bound by offset.
+		* A clean transient slot keeps its allocation until the allocator moves to the next frame.
+		* Returns false when transient is exhausted, the block is left unbound and the draw has to be skipped.
+		*/
+		template<typename... Slots>
+		[[nodiscard]]
+		bool set_bindings(const BindingSet<Slots...>& bs, TransientUniformAllocator& transient) const noexcept {
+			static_assert(detail::DoesUserBindingSetMatch<BindingSet<Slots...>, BS>::kValue, "User-defined BindingSet does not match the pipeline's binding set!");
+			return set_bindings_(bs, ~u64(0), &transient);
+		}
+
+		template<typename... Slots>
+		[[nodiscard]]
+		bool set_bindings(BindingSet<Slots...>& bs, TransientUniformAllocator& transient) const noexcept {
+			static_assert(detail::DoesUserBindingSetMatch<BindingSet<Slots...>, BS>::kValue, "User-defined BindingSet does not match the pipeline's binding set!");
+			return set_tracked_bindings_(bs, &transient);
 		}
 
 		template<TVtxElem Elem>
 		void draw(VertexBufferRC<Elem> vb, size_t vertex_count, size_t offset) const noexcept {
 			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
-			detail::draw_impl_(topology_, vb.get().handle, vertex_count, offset);
+			detail::bind_vertex_input_(kAttrs, vb.get().handle, 0, 0);
+			detail::draw_impl_(topology_, vertex_count, offset);
+		}
+
+		template<TVtxElem Elem, TIndexElem Idx>
+		void draw_indexed(VertexBufferRC<Elem> vb, IndexBufferRC<Idx> ib, size_t index_count, size_t offset) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			detail::bind_vertex_input_(kAttrs, vb.get().handle, ib.get().handle, 0);
+			detail::draw_indexed_impl_(topology_, kIndexType<Idx>, index_count, offset);
 		}
 
+		/*
+		* Draws index_count indices starting at first_index, base_vertex is added to every index.
+		* Lets many meshes of the same vertex layout share one vertex/index buffer pair, 
+		* in which case consecutive draws keep the same VAO bound.
+		*/
+		template<TVtxElem Elem, TIndexElem Idx>
+		void draw_indexed(VertexBufferRC<Elem> vb, IndexBufferRC<Idx> ib, size_t index_count, size_t first_index, i32 base_vertex) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			detail::bind_vertex_input_(kAttrs, vb.get().handle, ib.get().handle, 0);
+			detail::draw_indexed_base_vertex_impl_(topology_, kIndexType<Idx>, index_count, first_index, base_vertex);
+		}
+
+		/*
+		* Buffer view overloads, e.g. for StreamBuffer slices.
+		* The view's byte offset is turned into a first vertex/index, so vertices must be tightly packed.
+		*/
 		template<TVtxElem Elem>
-		void draw_indexed(VertexBufferRC<Elem> vb, IndexBufferRC ib, size_t index_count, size_t offset) const noexcept {
+		void draw(const VertexBufferView<Elem>& vb, size_t vertex_count, size_t offset = 0) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			static_assert(sizeof(Elem) == kGetVtxElemSize<Attrs>, "Vertices sourced from a buffer view must be tightly packed!");
+			assert(vb.offset % sizeof(Elem) == 0);
+			detail::bind_vertex_input_(kAttrs, vb.handle, 0, 0);
+			detail::draw_impl_(topology_, vertex_count, vb.offset / sizeof(Elem) + offset);
+		}
+
+		template<TVtxElem Elem, TIndexElem Idx>
+		void draw_indexed(const VertexBufferView<Elem>& vb, const IndexBufferView<Idx>& ib, size_t index_count, size_t first_index = 0) const noexcept {
 			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
-			detail::draw_indexed_impl_(topology_, vb.get().handle, ib.get().handle, index_count, offset);
+			static_assert(sizeof(Elem) == kGetVtxElemSize<Attrs>, "Vertices sourced from a buffer view must be tightly packed!");
+			assert(vb.offset % sizeof(Elem) == 0 && ib.offset % sizeof(Idx) == 0);
+			detail::bind_vertex_input_(kAttrs, vb.handle, ib.handle, 0);
+			detail::draw_indexed_base_vertex_impl_(
+				topology_, kIndexType<Idx>, index_count,
+				ib.offset / sizeof(Idx) + first_index,
+				static_cast<i32>(vb.offset / sizeof(Elem))
+			);
+		}
+
+		/*
+		* Pipeline attributes are sourced from vb first and then from instances. 
+		* Instance attributes step once per instance unless InstElem declares another step rate.
+		*/
+		template<TVtxElem Elem, TVtxElem InstElem>
+		void draw_instanced(VertexBufferRC<Elem> vb, VertexBufferRC<InstElem> instances, size_t vertex_count, size_t instance_count, size_t offset) const noexcept {
+			using Layout = InstancedLayout_<Elem, InstElem>;
+			static_assert(std::same_as<typename StripStepRate<Attrs>::Type, typename StripStepRate<Layout>::Type>, "Vertex and instance buffers' attributes do not match the pipeline's vertex attributes!");
+			detail::bind_vertex_input_(kVtxAttrArray<Layout>, vb.get().handle, 0, instances.get().handle);
+			detail::draw_instanced_impl_(topology_, vertex_count, instance_count, offset);
+		}
+
+		template<TVtxElem Elem, TVtxElem InstElem, TIndexElem Idx>
+		void draw_indexed_instanced(VertexBufferRC<Elem> vb, VertexBufferRC<InstElem> instances, IndexBufferRC<Idx> ib, size_t index_count, size_t instance_count, size_t offset) const noexcept {
+			using Layout = InstancedLayout_<Elem, InstElem>;
+			static_assert(std::same_as<typename StripStepRate<Attrs>::Type, typename StripStepRate<Layout>::Type>, "Vertex and instance buffers' attributes do not match the pipeline's vertex attributes!");
+			detail::bind_vertex_input_(kVtxAttrArray<Layout>, vb.get().handle, ib.get().handle, instances.get().handle);
+			detail::draw_indexed_instanced_impl_(topology_, kIndexType<Idx>, index_count, instance_count, offset);
 		}
 
 		void finish() noexcept {
-			if (vao_ != detail::kInvalidVAHandle) {
-				vao_ = detail::kInvalidVAHandle;
+			if (program_ != kShaderInvalidHandle) {
 				program_ = kShaderInvalidHandle;
 				topology_ = PrimitiveTopologyType::eCount;
 
 				detail::release_context_();
-				detail::unset_pipeline_impl_();
 			}
 		}
 
@@ -162,45 +313,205 @@ namespace minirhi
 			detail::clear_stencil_buffer_impl_();
 		}
 
+		/*
+		* Submits draw_count DrawIndexedIndirectCommand's starting at first_command with a single glMultiDrawElementsIndirect.
+		* Without multi draw indirect support the commands are issued one by one, 
+		* reading them back from the buffer if indirect draws are not supported at all.
+		*/
+		template<TVtxElem Elem, TIndexElem Idx>
+		void multi_draw_indexed_indirect(VertexBufferRC<Elem> vb, IndexBufferRC<Idx> ib, IndirectBufferRC commands, size_t draw_count, size_t first_command = 0) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			detail::bind_vertex_input_(kAttrs, vb.get().handle, ib.get().handle, 0);
+			detail::multi_draw_indexed_indirect_impl_(topology_, kIndexType<Idx>, commands.get().handle, draw_count, first_command);
+		}
+
 	private:
+		template<typename Elem, typename InstElem>
+		using InstancedLayout_ = typename ConcatVtxAttrArr<MakeVertexAttributes<Elem>, MakeInstanceAttributes<InstElem>>::Type;
+
+		template<typename... Slots>
+		bool set_tracked_bindings_(BindingSet<Slots...>& bs, TransientUniformAllocator* transient) const noexcept {
+			const bool tracked = bs.applied_program == program_ && bs.applied_epoch == detail::get_uniform_epoch_(program_);
+			if (!set_bindings_(bs, tracked ? bs.dirty_mask : ~u64(0), transient)) {
+				// Keeps the set dirty, so the next attempt uploads everything again.
+				return false;
+			}
+
+			bs.dirty_mask = 0;
+			bs.applied_program = program_;
+			bs.applied_epoch = detail::get_uniform_epoch_(program_);
+			return true;
+		}
+
+		// Returns false if a transient block couldn't be allocated.
+		template<typename... Slots>
+		bool set_bindings_(const BindingSet<Slots...>& bs, u64 mask, TransientUniformAllocator* transient) const noexcept {
+			u32 bound_texture_count = 0;
+			bool bound = true;
+			[&]<std::size_t... Is>([[maybe_unused]] std::index_sequence<Is...>) {
+				((bound = set_binding_(
+					bs.template get_slot<detail::MatchingSlot_<std::tuple_element_t<Is, typename BS::Tuple>, Slots...>>(), 
+					locations_[Is], 
+					bound_texture_count, 
+					((mask >> BindingSet<Slots...>::template kSlotIndex<detail::MatchingSlot_<std::tuple_element_t<Is, typename BS::Tuple>, Slots...>>) & 1u) != 0,
+					transient
+				) && bound), ...);
+			}(std::make_index_sequence<BS::kSlotCount>{});
+			return bound;
+		}
+
 		template<template<typename, typename> typename Slot, typename Type, typename Name>
-		void set_binding_(const Slot<Type, Name>& v, u32& bound_texture_count) const noexcept {
+		bool set_binding_(const Slot<Type, Name>& v, i32 location, u32& bound_texture_count, bool dirty, [[maybe_unused]] TransientUniformAllocator* transient) const noexcept {
 			static constexpr FixedString  kName = Name::kValue;
 			if constexpr (std::same_as<Slot<Type, Name>, Texture2DSlot<kName>>) {
-				detail::set_texture2d_binding_impl_(bound_texture_count, program_, std::string_view(kName), v.value.get().handle);
+				// Texture units are context state, so the texture is rebound even if the slot is clean.
+				if (dirty) {
+					detail::set_sampler_binding_impl_(program_, location, bound_texture_count);
+				}
+				detail::bind_texture2d_impl_(bound_texture_count, v.value.get().handle);
 				bound_texture_count++;
-				return;
+				return true;
 			} 
+			if constexpr (SlotTraits<Slot<Type, Name>>::kIsTransient) {
+				if (dirty || v.frame != transient->frame() || !v.range.is_valid()) {
+					v.range = transient->push(v.value);
+					v.frame = transient->frame();
+				}
+				if (!v.range.is_valid()) {
+					return false;
+				}
+				if (location >= 0) {
+					detail::bind_uniform_buffer_impl_(u32(location), v.range);
+				}
+				return true;
+			}
+			if constexpr (SlotTraits<Slot<Type, Name>>::kIsUniformBlock && !SlotTraits<Slot<Type, Name>>::kIsTransient) {
+				// Binding points are context state as well, location holds the block's binding point.
+				if (location >= 0) {
+					detail::bind_uniform_buffer_impl_(u32(location), v.value);
+				}
+				return true;
+			}
+			if (!dirty) {
+				return true;
+			}
 			if constexpr (std::same_as<Slot<Type, Name>, UIntSlot<kName>>) {
-				detail::set_uint_binding_impl_(program_, std::string_view(kName), v.value);
-				return;
+				detail::set_uint_binding_impl_(program_, location, v.value);
+				return true;
 			} 
 			if constexpr (std::same_as<Slot<Type, Name>, FloatSlot<kName>>) {
-				detail::set_float_binding_impl_(program_, std::string_view(kName), v.value);
+				detail::set_float_binding_impl_(program_, location, v.value);
 			}
 			if constexpr (std::same_as<Slot<Type, Name>, Mat4Slot<kName>>) {
-				detail::set_mat4_binding_impl_(program_, std::string_view(kName), v.value);
+				detail::set_mat4_binding_impl_(program_, location, v.value);
 			}
+			return true;
 		}
 
 	};
 
 	class CmdCtx {
+		friend class CommandList;
 	public:
+		// Draws into the default framebuffer.
 		template<typename Attrs, typename BS>
 		[[nodiscard]]
 		static DrawCtx<Attrs, BS> start_draw_context(const Viewport& vp, GraphicsPipeline<Attrs, BS> ps) noexcept {
+			MINIRHI_TRACE_SCOPE("start_draw_context");
 			detail::borrow_context_();
-			static constexpr auto kAttrs = get_vtx_attr_array(Attrs{});
-			
-			u32 vao = create_vao_();
-			setup_pipeline_(vao, kAttrs, ps.raw, vp);
+			detail::bind_framebuffer_impl_(0);
+			setup_pipeline_(ps.raw, vp);
+
+			return DrawCtx<Attrs, BS>(u32(ps.raw.state.program), PrimitiveTopologyType(u32(ps.raw.state.topology)), ps.locations);
+		}
 
-			return DrawCtx<Attrs, BS>(vao, u32(ps.raw.state.program), PrimitiveTopologyType(u32(ps.raw.state.topology)));
+		// Draws into fb, the textures attached to it must not be bound while drawing.
+		template<typename Attrs, typename BS>
+		[[nodiscard]]
+		static DrawCtx<Attrs, BS> start_draw_context(const Framebuffer& fb, const Viewport& vp, GraphicsPipeline<Attrs, BS> ps) noexcept {
+			MINIRHI_TRACE_SCOPE("start_draw_context");
+			assert(fb.is_valid());
+			detail::borrow_context_();
+			detail::bind_framebuffer_impl_(fb.handle);
+			setup_pipeline_(ps.raw, vp);
+
+			return DrawCtx<Attrs, BS>(u32(ps.raw.state.program), PrimitiveTopologyType(u32(ps.raw.state.topology)), ps.locations);
+		}
+
+		// Draws into the whole fb.
+		template<typename Attrs, typename BS>
+		[[nodiscard]]
+		static DrawCtx<Attrs, BS> start_draw_context(const Framebuffer& fb, GraphicsPipeline<Attrs, BS> ps) noexcept {
+			return start_draw_context(fb, Viewport{ fb.desc.width, fb.desc.height }, ps);
 		}
+
+		/*
+		* Switches from a pipeline of type From to `to`. The GL calls for fixed function state that differs
+		* between the two types are picked at compile time, only the program and viewport are compared at runtime.
+		* Falls back to a full setup if the current state is not the one of From, e.g. after invalidate_state_cache().
+		* Keeps drawing into the framebuffer of the previous draw context.
+		*/
+		template<TStaticGraphicsPipeline From, TStaticGraphicsPipeline To>
+		[[nodiscard]]
+		static DrawCtx<typename To::Attributes, typename To::Bindings> transition(const Viewport& vp, const To& to) noexcept {
+			detail::borrow_context_();
+			if (is_current_state_(From::kRaw)) {
+				transition_state_<From, To>();
+				finish_transition_(to.raw, vp);
+			} else {
+				setup_pipeline_(to.raw, vp);
+			}
+
+			return DrawCtx<typename To::Attributes, typename To::Bindings>(u32(to.raw.state.program), To::kState.topology, to.locations);
+		}
+
+		/*
+		* GL state is not reset when a draw context finishes, MiniRHI keeps a shadow copy of it instead.
+		* Call this after changing GL state outside of MiniRHI so the next draw context reapplies everything.
+		*/
+		static void invalidate_state_cache() noexcept;
+
 	private:
-		static void setup_pipeline_(u32 vao, std::span<const VtxAttrData> attribs, detail::GraphicsPipelineRaw pipeline, const Viewport& vp) noexcept;
-		static u32 create_vao_() noexcept;
+		static void setup_pipeline_(detail::GraphicsPipelineRaw pipeline, const Viewport& vp) noexcept;
+
+		// Compares the shadowed fixed function state, ignoring the program.
+		[[nodiscard]]
+		static bool is_current_state_(detail::GraphicsPipelineRaw pipeline) noexcept;
+		// Applies the program and viewport and stores the new pipeline in the shadow.
+		static void finish_transition_(detail::GraphicsPipelineRaw pipeline, const Viewport& vp) noexcept;
+
+		template<typename From, typename To>
+		static void transition_state_() noexcept {
+			static constexpr auto kFrom = detail::normalize_static_pipeline_(From::kRaw).state;
+			static constexpr auto kTo = detail::normalize_static_pipeline_(To::kRaw).state;
+
+			if constexpr (kFrom.enable_depth != kTo.enable_depth) {
+				detail::set_depth_test_impl_(bool(kTo.enable_depth));
+			}
+			if constexpr (kFrom.depth_mask != kTo.depth_mask) {
+				detail::set_depth_mask_impl_(DepthMask(u32(kTo.depth_mask)));
+			}
+			if constexpr (kFrom.depth_fn != kTo.depth_fn) {
+				detail::set_depth_func_impl_(DepthFunc(u32(kTo.depth_fn)));
+			}
+			if constexpr (kFrom.cull_mode_enabled != kTo.cull_mode_enabled) {
+				detail::set_cull_face_enabled_impl_(bool(kTo.cull_mode_enabled));
+			}
+			// The cull mode is left alone while culling is disabled, so it is only known if From culls.
+			if constexpr (bool(kTo.cull_mode_enabled) && (!bool(kFrom.cull_mode_enabled) || kFrom.cull_mode != kTo.cull_mode)) {
+				detail::set_cull_face_impl_(CullFaceMode(u32(kTo.cull_mode)));
+			}
+			if constexpr (kFrom.front_face != kTo.front_face) {
+				detail::set_front_face_impl_(FrontFace(u32(kTo.front_face)));
+			}
+			if constexpr (kFrom.polygon_mode != kTo.polygon_mode) {
+				detail::set_polygon_mode_impl_(PolygonMode(u32(kTo.polygon_mode)));
+			}
+			if constexpr (kFrom.line_smooth_enabled != kTo.line_smooth_enabled) {
+				detail::set_line_smooth_impl_(bool(kTo.line_smooth_enabled));
+			}
+		}
+
 		void draw_internal_(PrimitiveTopologyType type, size_t vertex_count, size_t offset) noexcept;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,462 @@
+#pragma once
+#include <array>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "MiniRHI/CmdCtx.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	namespace detail::cmd {
+		enum class Type : u8 {
+			eSetPipeline = 0,
+			eClearColor,
+			eClearDepth,
+			eClearStencil,
+			eBindVertexInput,
+			eBindTexture,
+			eSetSampler,
+			eSetUInt,
+			eSetFloat,
+			eSetMat4,
+			eBindUniformBuffer,
+			eDraw,
+			eDrawIndexed,
+			eDrawIndexedBaseVertex,
+			eDrawInstanced,
+			eDrawIndexedInstanced,
+			eMultiDrawIndexedIndirect,
+			eCount,
+		};
+
+		struct Header {
+			Type type;
+			// Size of the header and the command in bytes
+			u32 size;
+		};
+
+		struct SetPipeline {
+			static constexpr Type kType = Type::eSetPipeline;
+			GraphicsPipelineRaw pipeline;
+			Viewport viewport;
+		};
+
+		struct ClearColor {
+			static constexpr Type kType = Type::eClearColor;
+			f32 r, g, b, a;
+		};
+
+		struct ClearDepth {
+			static constexpr Type kType = Type::eClearDepth;
+		};
+
+		struct ClearStencil {
+			static constexpr Type kType = Type::eClearStencil;
+		};
+
+		struct BindVertexInput {
+			static constexpr Type kType = Type::eBindVertexInput;
+			// Points into a kVtxAttrArray, which has static storage duration
+			const VtxAttrData* attribs;
+			u32 attrib_count;
+			u32 vb;
+			u32 ib;
+			u32 instance_vb;
+		};
+
+		struct BindTexture {
+			static constexpr Type kType = Type::eBindTexture;
+			u32 unit;
+			u32 texture;
+		};
+
+		struct SetSampler {
+			static constexpr Type kType = Type::eSetSampler;
+			u32 program;
+			i32 location;
+			u32 unit;
+		};
+
+		struct SetUInt {
+			static constexpr Type kType = Type::eSetUInt;
+			u32 program;
+			i32 location;
+			u32 value;
+		};
+
+		struct SetFloat {
+			static constexpr Type kType = Type::eSetFloat;
+			u32 program;
+			i32 location;
+			f32 value;
+		};
+
+		struct SetMat4 {
+			static constexpr Type kType = Type::eSetMat4;
+			u32 program;
+			i32 location;
+			glm::mat4 value;
+		};
+
+		struct BindUniformBuffer {
+			static constexpr Type kType = Type::eBindUniformBuffer;
+			u32 binding;
+			UniformBufferRange range;
+		};
+
+		struct Draw {
+			static constexpr Type kType = Type::eDraw;
+			PrimitiveTopologyType topology;
+			u32 vertex_count;
+			u32 offset;
+		};
+
+		struct DrawIndexed {
+			static constexpr Type kType = Type::eDrawIndexed;
+			PrimitiveTopologyType topology;
+			IndexType index_type;
+			u32 index_count;
+			u32 offset;
+		};
+
+		struct DrawIndexedBaseVertex {
+			static constexpr Type kType = Type::eDrawIndexedBaseVertex;
+			PrimitiveTopologyType topology;
+			IndexType index_type;
+			u32 index_count;
+			u32 first_index;
+			i32 base_vertex;
+		};
+
+		struct DrawInstanced {
+			static constexpr Type kType = Type::eDrawInstanced;
+			PrimitiveTopologyType topology;
+			u32 vertex_count;
+			u32 instance_count;
+			u32 offset;
+		};
+
+		struct DrawIndexedInstanced {
+			static constexpr Type kType = Type::eDrawIndexedInstanced;
+			PrimitiveTopologyType topology;
+			IndexType index_type;
+			u32 index_count;
+			u32 instance_count;
+			u32 offset;
+		};
+
+		struct MultiDrawIndexedIndirect {
+			static constexpr Type kType = Type::eMultiDrawIndexedIndirect;
+			PrimitiveTopologyType topology;
+			IndexType index_type;
+			u32 indirect_buffer;
+			u32 draw_count;
+			u32 first_command;
+		};
+	}
+
+	template<typename Attrs, typename BS>
+	class CommandRecorder;
+
+	/*
+	* Commands recorded into a linear arena of fixed size chunks, replayed on the GL thread by submit().
+	* Recording doesn't touch GL, so it can happen on any thread, and a list can be submitted any number of times.
+	* Only raw handles are recorded: buffers and textures must stay alive while the list is in use,
+	* and views into StreamBuffers/transient allocators are only valid for the frame they were made in.
+	*/
+	class CommandList {
+	public:
+		static constexpr std::size_t kChunkSize = 64 * 1024;
+		static constexpr std::size_t kCommandAlignment = 8;
+
+		explicit CommandList() noexcept = default;
+
+		CommandList(const CommandList&) = delete;
+		CommandList& operator=(const CommandList&) = delete;
+
+		CommandList(CommandList&&) noexcept = default;
+		CommandList& operator=(CommandList&&) noexcept = default;
+
+		// Records the pipeline setup and returns a recorder for draws with it.
+		template<typename Attrs, typename BS>
+		[[nodiscard]]
+		CommandRecorder<Attrs, BS> record(const Viewport& vp, const GraphicsPipeline<Attrs, BS>& ps) noexcept;
+
+		template<typename Cmd>
+		void push(const Cmd& cmd) noexcept {
+			static_assert(std::is_trivially_copyable_v<Cmd> && alignof(Cmd) <= kCommandAlignment);
+			constexpr std::size_t kSize = align_(sizeof(detail::cmd::Header)) + align_(sizeof(Cmd));
+
+			std::byte* dst = allocate_(kSize);
+			const detail::cmd::Header header{ Cmd::kType, u32(kSize) };
+			std::memcpy(dst, &header, sizeof(header));
+			std::memcpy(dst + align_(sizeof(detail::cmd::Header)), &cmd, sizeof(Cmd));
+			command_count_++;
+		}
+
+		// Borrows the context and replays every command.
+		void submit() const noexcept;
+
+		// Forgets the recorded commands, chunks are kept for reuse.
+		void reset() noexcept;
+
+		[[nodiscard]]
+		std::size_t command_count() const noexcept {
+			return command_count_;
+		}
+
+		[[nodiscard]]
+		bool is_empty() const noexcept {
+			return command_count_ == 0;
+		}
+
+	private:
+		friend class ParallelCommandList;
+		friend class RenderQueue;
+
+		// Position in the arena, commands recorded between two marks form a range.
+		struct Mark {
+			std::size_t chunk = 0;
+			std::size_t offset = 0;
+		};
+
+		struct Chunk {
+			std::unique_ptr<std::byte[]> data;
+			std::size_t used = 0;
+		};
+
+		[[nodiscard]]
+		static constexpr std::size_t align_(std::size_t size) noexcept {
+			return (size + kCommandAlignment - 1) & ~(kCommandAlignment - 1);
+		}
+
+		std::byte* allocate_(std::size_t size) noexcept;
+
+		[[nodiscard]]
+		Mark mark_() const noexcept {
+			return chunks_.empty() ? Mark{} : Mark{ current_chunk_, chunks_[current_chunk_].used };
+		}
+
+		// Replays without borrowing the context.
+		void replay_() const noexcept {
+			replay_range_(Mark{}, mark_());
+		}
+
+		void replay_range_(Mark begin, Mark end) const noexcept;
+
+		std::vector<Chunk> chunks_;
+		std::size_t current_chunk_ = 0;
+		std::size_t command_count_ = 0;
+	};
+
+	/*
+	* Records commands into a CommandList with the same interface as DrawCtx.
+	* Every set_bindings call records all slots, redundant uploads are filtered by the state shadow on replay.
+	* Resources are taken by reference, so recording on worker threads never touches their reference counts.
+	*/
+	template<typename Attrs, typename BS>
+	class [[nodiscard]] CommandRecorder {
+		friend class CommandList;
+	private:
+		static constexpr const auto& kAttrs = kVtxAttrArray<Attrs>;
+
+		CommandList* list_ = nullptr;
+		u32 program_ = kShaderInvalidHandle;
+		PrimitiveTopologyType topology_ = PrimitiveTopologyType::eTriangle;
+		std::array<i32, BS::kSlotCount> locations_{};
+
+		CommandRecorder(CommandList& list, u32 program, PrimitiveTopologyType topology, const std::array<i32, BS::kSlotCount>& locations) noexcept
+			: list_(&list)
+			, program_(program)
+			, topology_(topology)
+			, locations_(locations)
+		{}
+
+	public:
+		template<typename... Slots>
+		void set_bindings(const BindingSet<Slots...>& bs) const noexcept {
+			static_assert(detail::DoesUserBindingSetMatch<BindingSet<Slots...>, BS>::kValue, "User-defined BindingSet does not match the pipeline's binding set!");
+			static_assert(!BindingSet<Slots...>::kHasTransientSlots, "Transient uniform blocks can't be recorded, bind a ConstantBufferView instead!");
+			u32 bound_texture_count = 0;
+			[&]<std::size_t... Is>([[maybe_unused]] std::index_sequence<Is...>) {
+				(record_binding_(
+					bs.template get_slot<detail::MatchingSlot_<std::tuple_element_t<Is, typename BS::Tuple>, Slots...>>(),
+					locations_[Is],
+					bound_texture_count
+				), ...);
+			}(std::make_index_sequence<BS::kSlotCount>{});
+		}
+
+		void clear_color_buffer(f32 r, f32 g, f32 b, f32 a) const noexcept {
+			list_->push(detail::cmd::ClearColor{ r, g, b, a });
+		}
+
+		void clear_depth_buffer() const noexcept {
+			list_->push(detail::cmd::ClearDepth{});
+		}
+
+		void clear_stencil_buffer() const noexcept {
+			list_->push(detail::cmd::ClearStencil{});
+		}
+
+		template<TVtxElem Elem>
+		void draw(const VertexBufferRC<Elem>& vb, size_t vertex_count, size_t offset) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			bind_vertex_input_(kAttrs, vb.get().handle, 0, 0);
+			list_->push(detail::cmd::Draw{ topology_, u32(vertex_count), u32(offset) });
+		}
+
+		template<TVtxElem Elem, TIndexElem Idx>
+		void draw_indexed(const VertexBufferRC<Elem>& vb, const IndexBufferRC<Idx>& ib, size_t index_count, size_t offset) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			bind_vertex_input_(kAttrs, vb.get().handle, ib.get().handle, 0);
+			list_->push(detail::cmd::DrawIndexed{ topology_, kIndexType<Idx>, u32(index_count), u32(offset) });
+		}
+
+		template<TVtxElem Elem, TIndexElem Idx>
+		void draw_indexed(const VertexBufferRC<Elem>& vb, const IndexBufferRC<Idx>& ib, size_t index_count, size_t first_index, i32 base_vertex) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			bind_vertex_input_(kAttrs, vb.get().handle, ib.get().handle, 0);
+			list_->push(detail::cmd::DrawIndexedBaseVertex{ topology_, kIndexType<Idx>, u32(index_count), u32(first_index), base_vertex });
+		}
+
+		template<TVtxElem Elem>
+		void draw(const VertexBufferView<Elem>& vb, size_t vertex_count, size_t offset = 0) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			static_assert(sizeof(Elem) == kGetVtxElemSize<Attrs>, "Vertices sourced from a buffer view must be tightly packed!");
+			assert(vb.offset % sizeof(Elem) == 0);
+			bind_vertex_input_(kAttrs, vb.handle, 0, 0);
+			list_->push(detail::cmd::Draw{ topology_, u32(vertex_count), u32(vb.offset / sizeof(Elem) + offset) });
+		}
+
+		template<TVtxElem Elem, TIndexElem Idx>
+		void draw_indexed(const VertexBufferView<Elem>& vb, const IndexBufferView<Idx>& ib, size_t index_count, size_t first_index = 0) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			static_assert(sizeof(Elem) == kGetVtxElemSize<Attrs>, "Vertices sourced from a buffer view must be tightly packed!");
+			assert(vb.offset % sizeof(Elem) == 0 && ib.offset % sizeof(Idx) == 0);
+			bind_vertex_input_(kAttrs, vb.handle, ib.handle, 0);
+			list_->push(detail::cmd::DrawIndexedBaseVertex{
+				topology_, kIndexType<Idx>, u32(index_count),
+				u32(ib.offset / sizeof(Idx) + first_index),
+				i32(vb.offset / sizeof(Elem))
+			});
+		}
+
+		template<TVtxElem Elem, TVtxElem InstElem>
+		void draw_instanced(const VertexBufferRC<Elem>& vb, const VertexBufferRC<InstElem>& instances, size_t vertex_count, size_t instance_count, size_t offset) const noexcept {
+			using Layout = InstancedLayout_<Elem, InstElem>;
+			static_assert(std::same_as<typename StripStepRate<Attrs>::Type, typename StripStepRate<Layout>::Type>, "Vertex and instance buffers' attributes do not match the pipeline's vertex attributes!");
+			bind_vertex_input_(kVtxAttrArray<Layout>, vb.get().handle, 0, instances.get().handle);
+			list_->push(detail::cmd::DrawInstanced{ topology_, u32(vertex_count), u32(instance_count), u32(offset) });
+		}
+
+		template<TVtxElem Elem, TVtxElem InstElem, TIndexElem Idx>
+		void draw_indexed_instanced(const VertexBufferRC<Elem>& vb, const VertexBufferRC<InstElem>& instances, const IndexBufferRC<Idx>& ib, size_t index_count, size_t instance_count, size_t offset) const noexcept {
+			using Layout = InstancedLayout_<Elem, InstElem>;
+			static_assert(std::same_as<typename StripStepRate<Attrs>::Type, typename StripStepRate<Layout>::Type>, "Vertex and instance buffers' attributes do not match the pipeline's vertex attributes!");
+			bind_vertex_input_(kVtxAttrArray<Layout>, vb.get().handle, ib.get().handle, instances.get().handle);
+			list_->push(detail::cmd::DrawIndexedInstanced{ topology_, kIndexType<Idx>, u32(index_count), u32(instance_count), u32(offset) });
+		}
+
+		template<TVtxElem Elem, TIndexElem Idx>
+		void multi_draw_indexed_indirect(const VertexBufferRC<Elem>& vb, const IndexBufferRC<Idx>& ib, const IndirectBufferRC& commands, size_t draw_count, size_t first_command = 0) const noexcept {
+			static_assert(std::same_as<Attrs, MakeVertexAttributes<Elem>>, "Vertex buffer's vertex attributes does not match the pipeline's vertex attributes!");
+			bind_vertex_input_(kAttrs, vb.get().handle, ib.get().handle, 0);
+			list_->push(detail::cmd::MultiDrawIndexedIndirect{ topology_, kIndexType<Idx>, commands.get().handle, u32(draw_count), u32(first_command) });
+		}
+
+	private:
+		template<typename Elem, typename InstElem>
+		using InstancedLayout_ = typename ConcatVtxAttrArr<MakeVertexAttributes<Elem>, MakeInstanceAttributes<InstElem>>::Type;
+
+		void bind_vertex_input_(std::span<const VtxAttrData> attribs, u32 vb, u32 ib, u32 instance_vb) const noexcept {
+			list_->push(detail::cmd::BindVertexInput{ attribs.data(), u32(attribs.size()), vb, ib, instance_vb });
+		}
+
+		template<template<typename, typename> typename Slot, typename Type, typename Name>
+		void record_binding_(const Slot<Type, Name>& v, i32 location, u32& bound_texture_count) const noexcept {
+			static constexpr FixedString kName = Name::kValue;
+			if constexpr (std::same_as<Slot<Type, Name>, Texture2DSlot<kName>>) {
+				list_->push(detail::cmd::SetSampler{ program_, location, bound_texture_count });
+				list_->push(detail::cmd::BindTexture{ bound_texture_count, v.value.get().handle });
+				bound_texture_count++;
+			}
+			if constexpr (SlotTraits<Slot<Type, Name>>::kIsUniformBlock) {
+				if (location >= 0) {
+					list_->push(detail::cmd::BindUniformBuffer{ u32(location), v.value });
+				}
+			}
+			if constexpr (std::same_as<Slot<Type, Name>, UIntSlot<kName>>) {
+				list_->push(detail::cmd::SetUInt{ program_, location, v.value });
+			}
+			if constexpr (std::same_as<Slot<Type, Name>, FloatSlot<kName>>) {
+				list_->push(detail::cmd::SetFloat{ program_, location, v.value });
+			}
+			if constexpr (std::same_as<Slot<Type, Name>, Mat4Slot<kName>>) {
+				list_->push(detail::cmd::SetMat4{ program_, location, v.value });
+			}
+		}
+	};
+
+	/*
+	* One CommandList per recording job, e.g. per slice of the scene culled by a worker thread.
+	* Jobs record into their own list without any synchronisation. 
+	* submit() replays the lists in job order on the GL thread, so the result doesn't depend on scheduling.
+	*/
+	class ParallelCommandList {
+	public:
+		explicit ParallelCommandList() noexcept = default;
+		explicit ParallelCommandList(std::size_t job_count) noexcept
+			: lists_(job_count)
+		{}
+
+		[[nodiscard]]
+		CommandList& operator[](std::size_t job) noexcept {
+			assert(job < lists_.size());
+			return lists_[job].list;
+		}
+
+		[[nodiscard]]
+		const CommandList& operator[](std::size_t job) const noexcept {
+			assert(job < lists_.size());
+			return lists_[job].list;
+		}
+
+		[[nodiscard]]
+		std::size_t job_count() const noexcept {
+			return lists_.size();
+		}
+
+		// Lists of new jobs start empty, lists of the remaining ones are kept.
+		void resize(std::size_t job_count) noexcept {
+			lists_.resize(job_count);
+		}
+
+		// Borrows the context once and replays every list in job order.
+		void submit() const noexcept;
+
+		void reset() noexcept;
+
+		[[nodiscard]]
+		std::size_t command_count() const noexcept;
+
+	private:
+		static constexpr std::size_t kCacheLineSize = 64;
+
+		// Keeps lists recorded by different threads off each other's cache lines.
+		struct alignas(kCacheLineSize) Job {
+			CommandList list;
+		};
+
+		std::vector<Job> lists_;
+	};
+
+	template<typename Attrs, typename BS>
+	CommandRecorder<Attrs, BS> CommandList::record(const Viewport& vp, const GraphicsPipeline<Attrs, BS>& ps) noexcept {
+		push(detail::cmd::SetPipeline{ ps.raw, vp });
+		return CommandRecorder<Attrs, BS>(*this, u32(ps.raw.state.program), PrimitiveTopologyType(u32(ps.raw.state.topology)), ps.locations);
+	}
+}
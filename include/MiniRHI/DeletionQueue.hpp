@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+#include "MiniRHI/Fence.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	enum class DeletionKind : u8 {
+		eBuffer = 0,
+		eTexture,
+		eFramebuffer,
+	};
+
+	struct PendingDeletion {
+		u32 handle = 0;
+		DeletionKind kind = DeletionKind::eBuffer;
+	};
+
+	namespace detail {
+		// Queues handle on the active DeletionQueue from any thread. Returns false when there is none, the caller deletes right away then.
+		bool defer_deletion_(DeletionKind kind, u32 handle) noexcept;
+
+		// True while a DeletionQueue is active, i.e. destroying a resource is safe from any thread.
+		[[nodiscard]]
+		bool is_deferring_deletions_() noexcept;
+	}
+
+	/*
+	* Keeps GL objects alive until the GPU is done with the frames that used them.
+	* While a queue is active, BufferStorage::destroy, Texture::destroy and Framebuffer::destroy
+	* (and with them the RC destructors) only push the handle to a lock-free MPSC queue, so they
+	* are safe to call from any thread. On the GL thread submit() moves everything pushed so far
+	* into a batch behind a new fence and collect() deletes the retired batches in bulk.
+	* FramePacer drives its own queue, one batch per frame.
+	* At most one queue can be active, destroying it waits for the GPU and deletes everything left.
+	*/
+	class DeletionQueue {
+	public:
+		explicit DeletionQueue() noexcept = default;
+
+		DeletionQueue(const DeletionQueue&) = delete;
+		DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+		DeletionQueue(DeletionQueue&& rhs) noexcept;
+		DeletionQueue& operator=(DeletionQueue&& rhs) noexcept;
+
+		~DeletionQueue() noexcept;
+
+		// Starts deferring destruction to this queue.
+		void activate() noexcept;
+
+		// Fences the deletions requested since the last submit.
+		void submit() noexcept;
+
+		// Deletes the batches whose fence has signaled, or waits for all of them.
+		void collect(bool wait = false) noexcept;
+
+		[[nodiscard]]
+		bool is_active() const noexcept {
+			return active_;
+		}
+
+		// Handles in submitted batches that are not deleted yet.
+		[[nodiscard]]
+		std::size_t get_pending_count() const noexcept;
+
+	private:
+		struct Batch {
+			Fence fence{};
+			std::vector<PendingDeletion> deletions;
+		};
+
+		void release_() noexcept;
+
+		// Submitted batches, oldest first
+		std::vector<Batch> batches_;
+		bool active_ = false;
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <limits>
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	/*
+	* GPU fence inserted into the command stream with glFenceSync.
+	* A default constructed fence counts as signaled.
+	*/
+	struct Fence {
+		void* sync = nullptr;
+
+		[[nodiscard]]
+		static Fence insert() noexcept;
+		static void destroy(Fence& fence) noexcept;
+
+		[[nodiscard]]
+		bool is_signaled() const noexcept;
+
+		// Blocks until the GPU reaches the fence. Returns false on timeout or error.
+		bool wait(u64 timeout_ns = std::numeric_limits<u64>::max()) const noexcept;
+
+		[[nodiscard]]
+		bool is_empty() const noexcept {
+			return sync == nullptr;
+		}
+	};
+}
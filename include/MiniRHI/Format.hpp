@@ -32,7 +32,12 @@ namespace minirhi
 		eRGB32_UInt, // 12
 		eRGBA32_UInt, // 16
 
-
+		// Depth and depth-stencil formats, only usable as texture formats
+		eD16_UNorm, // 2
+		eD24_UNorm, // 4
+		eD32_Float, // 4
+		eD24_UNorm_S8_UInt, // 4
+		eD32_Float_S8_UInt, // 8
 
 		eUnknown,
 		eCount,
@@ -42,6 +47,18 @@ namespace minirhi
 	u32 get_format_type(Format format) noexcept;
 	u32 get_pixel_format(Format format) noexcept;
 	size_t get_format_size(Format format) noexcept;
+	// Sized internal format for depth formats, same as get_pixel_format otherwise.
+	u32 get_internal_format(Format format) noexcept;
+
+	[[nodiscard]]
+	constexpr bool is_depth_format(Format format) noexcept {
+		return format >= Format::eD16_UNorm && format <= Format::eD32_Float_S8_UInt;
+	}
+
+	[[nodiscard]]
+	constexpr bool has_stencil(Format format) noexcept {
+		return format == Format::eD24_UNorm_S8_UInt || format == Format::eD32_Float_S8_UInt;
+	}
 
 	namespace format {
 		struct FormatBase {};
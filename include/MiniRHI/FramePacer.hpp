@@ -0,0 +1,134 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <span>
+
+#include "MiniRHI/DeletionQueue.hpp"
+#include "MiniRHI/Fence.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	struct FrameTiming {
+		// Time between the starts of two consecutive frames
+		f64 frame_ms = 0.0;
+		// Time from begin_frame() returning to end_frame()
+		f64 cpu_ms = 0.0;
+		// Time begin_frame() blocked on the GPU
+		f64 wait_ms = 0.0;
+	};
+
+	/*
+	* Bounds how far the CPU runs ahead of the GPU. Every frame is fenced in end_frame(),
+	* begin_frame() waits for the fence of the frame issued frames_in_flight frames earlier.
+	* One frame in flight gives the lowest latency, more frames let the CPU and GPU overlap.
+	* Frame slots cycle through [0, frames_in_flight), a slot's resources are free to overwrite
+	* once begin_frame() returns, see FrameSlots.
+	* The pacer activates a DeletionQueue: resources released during a frame are deleted
+	* when begin_frame() finds that frame retired.
+	*
+	* Example:
+	*     pacer.begin_frame();
+	*     render();
+	*     SDL_GL_SwapWindow(window);
+	*     pacer.end_frame();
+	*/
+	class FramePacer {
+	public:
+		static constexpr u32 kMaxFramesInFlight = 4;
+
+		explicit FramePacer() noexcept = default;
+		explicit FramePacer(u32 frames_in_flight) noexcept;
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		FramePacer(FramePacer&& rhs) noexcept;
+		FramePacer& operator=(FramePacer&& rhs) noexcept;
+
+		~FramePacer() noexcept;
+
+		// Waits until the current slot's previous frame has finished on the GPU.
+		void begin_frame() noexcept;
+
+		// Fences the commands of the frame and moves on to the next slot. Call after the swap.
+		void end_frame() noexcept;
+
+		// Waits for every frame in flight and deletes the resources they released.
+		void wait_idle() noexcept;
+
+		// Waits for every frame in flight, then restarts from slot 0. Has to be called between frames.
+		void set_frames_in_flight(u32 frames_in_flight) noexcept;
+
+		[[nodiscard]]
+		u32 get_frames_in_flight() const noexcept {
+			return frames_in_flight_;
+		}
+
+		// Slot of the current frame, in [0, get_frames_in_flight()).
+		[[nodiscard]]
+		u32 get_frame_slot() const noexcept {
+			return slot_;
+		}
+
+		// Number of frames ended so far.
+		[[nodiscard]]
+		u64 get_frame_index() const noexcept {
+			return frame_index_;
+		}
+
+		// Time between the starts of the previous and the current frame, 0 for the first frame.
+		[[nodiscard]]
+		f64 get_delta_ms() const noexcept {
+			return timing_.frame_ms;
+		}
+
+		// Timing of the last ended frame.
+		[[nodiscard]]
+		const FrameTiming& get_last_timing() const noexcept {
+			return last_timing_;
+		}
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		void release_() noexcept;
+
+		std::array<Fence, kMaxFramesInFlight> fences_{};
+		DeletionQueue deletions_;
+		u32 frames_in_flight_ = 0;
+		u32 slot_ = 0;
+		u64 frame_index_ = 0;
+		bool in_frame_ = false;
+		Clock::time_point frame_begin_{};
+		FrameTiming timing_{};
+		FrameTiming last_timing_{};
+	};
+
+	/*
+	* One T per frame slot, for resources the CPU rewrites every frame (uniform blocks, staging memory...).
+	* get() returns the instance the GPU is done with after FramePacer::begin_frame().
+	*/
+	template<typename T>
+	class FrameSlots {
+	public:
+		[[nodiscard]]
+		T& get(const FramePacer& pacer) noexcept {
+			return slots_[pacer.get_frame_slot()];
+		}
+
+		[[nodiscard]]
+		const T& get(const FramePacer& pacer) const noexcept {
+			return slots_[pacer.get_frame_slot()];
+		}
+
+		// Every slot, including the ones past the pacer's frames in flight.
+		[[nodiscard]]
+		std::span<T> all() noexcept {
+			return slots_;
+		}
+
+	private:
+		std::array<T, FramePacer::kMaxFramesInFlight> slots_{};
+	};
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "Format.hpp"
+#include "RC.hpp"
+#include "Texture.hpp"
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	inline static constexpr u32 kFramebufferInvalidHandle = std::numeric_limits<u32>::max();
+	// Minimum GL_MAX_COLOR_ATTACHMENTS guaranteed by GL 3.3 and GLES 3.0
+	inline static constexpr u32 kMaxColorAttachments = 4;
+
+	// Attachments are referenced by handle, the textures have to outlive the framebuffer.
+	struct FramebufferDesc {
+		std::array<u32, kMaxColorAttachments> color_attachments{};
+		u32 color_attachment_count = 0;
+		u32 depth_stencil_attachment = kInvalidTextureHandle;
+		Format depth_stencil_format = Format::eUnknown;
+		u32 width = 0;
+		u32 height = 0;
+
+		FramebufferDesc& add_color_attachment(const Texture& texture) noexcept {
+			assert(color_attachment_count < kMaxColorAttachments);
+			assert(!is_depth_format(texture.desc.pixel_format));
+			set_size_(texture);
+			color_attachments[color_attachment_count++] = texture.handle;
+			return *this;
+		}
+
+		FramebufferDesc& set_depth_stencil_attachment(const Texture& texture) noexcept {
+			assert(is_depth_format(texture.desc.pixel_format));
+			set_size_(texture);
+			depth_stencil_attachment = texture.handle;
+			depth_stencil_format = texture.desc.pixel_format;
+			return *this;
+		}
+
+	private:
+		void set_size_(const Texture& texture) noexcept {
+			assert((width == 0 || width == texture.desc.size.width) && (height == 0 || height == texture.desc.size.height) && "Framebuffer attachments must have the same size!");
+			width = texture.desc.size.width;
+			height = texture.desc.size.height;
+		}
+	};
+
+	namespace detail {
+		u32 create_framebuffer_impl_(const FramebufferDesc& desc) noexcept;
+	}
+
+	struct Framebuffer {
+		u32 handle = kFramebufferInvalidHandle;
+		FramebufferDesc desc;
+
+		static void destroy(Framebuffer& fb) noexcept;
+
+		explicit Framebuffer() noexcept = default;
+
+		explicit Framebuffer(const FramebufferDesc& fb_desc) noexcept
+			: handle(detail::create_framebuffer_impl_(fb_desc))
+			, desc(fb_desc)
+		{}
+
+		[[nodiscard]]
+		bool is_valid() const noexcept {
+			return handle != kFramebufferInvalidHandle;
+		}
+	};
+
+	using FramebufferRC = RC<Framebuffer>;
+
+	[[nodiscard]]
+	inline FramebufferRC make_framebuffer_rc(const FramebufferDesc& desc) noexcept {
+		return FramebufferRC{ desc };
+	}
+
+	struct RenderTargetDesc {
+		u32 width = 0;
+		u32 height = 0;
+		std::array<Format, kMaxColorAttachments> color_formats{};
+		u32 color_format_count = 0;
+		// Format::eUnknown for no depth attachment
+		Format depth_stencil_format = Format::eUnknown;
+		SamplerDesc sampler{};
+
+		RenderTargetDesc& add_color(Format format) noexcept {
+			assert(color_format_count < kMaxColorAttachments);
+			color_formats[color_format_count++] = format;
+			return *this;
+		}
+
+		RenderTargetDesc& set_depth_stencil(Format format) noexcept {
+			assert(format == Format::eUnknown || is_depth_format(format));
+			depth_stencil_format = format;
+			return *this;
+		}
+	};
+
+	/*
+	* A framebuffer together with the textures it renders into, which can be sampled once rendering is done.
+	* Depth-only targets (shadow maps) simply have no color attachments.
+	*/
+	struct RenderTarget {
+		std::vector<TextureRC> color_attachments;
+		// Empty for color-only targets, an empty RC can't be moved.
+		std::optional<TextureRC> depth_stencil_attachment;
+		FramebufferRC framebuffer;
+
+		[[nodiscard]]
+		const Framebuffer& get() const noexcept {
+			return framebuffer.get();
+		}
+	};
+
+	[[nodiscard]]
+	inline RenderTarget make_render_target(const RenderTargetDesc& desc) noexcept {
+		RenderTarget target;
+		FramebufferDesc fb_desc;
+		for (u32 i = 0; i < desc.color_format_count; i++) {
+			target.color_attachments.push_back(make_texture_2d_rc(desc.sampler, desc.width, desc.height, desc.color_formats[i], nullptr));
+			fb_desc.add_color_attachment(target.color_attachments.back().get());
+		}
+		if (desc.depth_stencil_format != Format::eUnknown) {
+			target.depth_stencil_attachment.emplace(make_texture_2d_rc(desc.sampler, desc.width, desc.height, desc.depth_stencil_format, nullptr));
+			fb_desc.set_depth_stencil_attachment(target.depth_stencil_attachment->get());
+		}
+		target.framebuffer = make_framebuffer_rc(fb_desc);
+		return target;
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	// Time spent in every scope with the same name during one frame.
+	struct GpuScopeResult {
+		std::string_view name;
+		f64 milliseconds = 0.0;
+		// Number of scopes merged into this result
+		u32 count = 0;
+		// Nesting depth of the first scope with this name
+		u32 depth = 0;
+	};
+
+	// One scope of a resolved frame, timestamps are in GPU nanoseconds (GL_TIMESTAMP).
+	struct GpuScopeTiming {
+		std::string_view name;
+		u64 begin = 0;
+		u64 end = 0;
+		u32 depth = 0;
+	};
+
+	/*
+	* Measures GPU time of named scopes with GL_TIMESTAMP queries, so scopes can nest.
+	* Queries of a frame are read frame_latency frames later, when the GPU has long finished them.
+	* If they are still not available by then, the frame is dropped instead of waiting.
+	* Disabled when the device has no timer queries (GLES), scopes are no-ops then.
+	* Scope names are not copied, use string literals.
+	*/
+	class GpuProfiler {
+	public:
+		// Largest frame_latency
+		static constexpr u32 kMaxFrames = 4;
+		static constexpr u32 kInvalidScope = std::numeric_limits<u32>::max();
+
+		explicit GpuProfiler() noexcept = default;
+		explicit GpuProfiler(u32 frame_latency) noexcept;
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		GpuProfiler(GpuProfiler&& rhs) noexcept;
+		GpuProfiler& operator=(GpuProfiler&& rhs) noexcept;
+
+		~GpuProfiler() noexcept;
+
+		[[nodiscard]]
+		u32 begin_scope(std::string_view name) noexcept;
+		void end_scope(u32 scope) noexcept;
+
+		// Resolves the oldest frame in flight and starts a new one. Every scope has to be closed.
+		void next_frame() noexcept;
+
+		// Results of the latest resolved frame, in order of first appearance.
+		[[nodiscard]]
+		std::span<const GpuScopeResult> get_results() const noexcept {
+			return results_;
+		}
+
+		// Unmerged scopes of the latest resolved frame, in the order they were opened.
+		[[nodiscard]]
+		std::span<const GpuScopeTiming> get_timings() const noexcept {
+			return timings_;
+		}
+
+		// Index of the frame get_results() belongs to, as counted by next_frame().
+		[[nodiscard]]
+		u64 get_results_frame() const noexcept {
+			return results_frame_;
+		}
+
+		[[nodiscard]]
+		u64 get_dropped_frame_count() const noexcept {
+			return dropped_frames_;
+		}
+
+		[[nodiscard]]
+		bool is_enabled() const noexcept {
+			return frame_count_ != 0;
+		}
+
+	private:
+		struct ScopeRecord {
+			std::string_view name;
+			u32 begin_query = 0;
+			u32 end_query = 0;
+			u32 depth = 0;
+		};
+
+		struct Frame {
+			std::vector<ScopeRecord> scopes;
+			u64 index = 0;
+		};
+
+		[[nodiscard]]
+		u32 acquire_query_() noexcept;
+		void resolve_(Frame& frame) noexcept;
+		void release_() noexcept;
+
+		// The frame being recorded plus frame_latency frames waiting for their queries
+		std::array<Frame, kMaxFrames + 1> frames_{};
+		u32 frame_count_ = 0;
+		u32 frame_ = 0;
+		u64 frame_index_ = 0;
+		u32 depth_ = 0;
+		std::vector<u32> free_queries_;
+		std::vector<GpuScopeResult> results_;
+		std::vector<GpuScopeTiming> timings_;
+		u64 results_frame_ = 0;
+		u64 dropped_frames_ = 0;
+	};
+
+	// Measures the GPU time of the commands issued during its lifetime.
+	class [[nodiscard]] GpuScope {
+	public:
+		explicit GpuScope(GpuProfiler& profiler, std::string_view name) noexcept
+			: profiler_(&profiler)
+			, scope_(profiler.begin_scope(name))
+		{}
+
+		GpuScope(const GpuScope&) = delete;
+		GpuScope& operator=(const GpuScope&) = delete;
+
+		~GpuScope() noexcept {
+			profiler_->end_scope(scope_);
+		}
+
+	private:
+		GpuProfiler* profiler_;
+		u32 scope_;
+	};
+}
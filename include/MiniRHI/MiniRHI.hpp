@@ -8,5 +8,17 @@
 #endif
 
 namespace minirhi {
+	// Optional features of the current context, queried once by minirhi::init().
+	struct DeviceCaps {
+		bool draw_indirect = false;
+		bool multi_draw_indirect = false;
+		bool buffer_storage = false;
+		bool invalidate_framebuffer = false;
+		bool timer_query = false;
+	};
+
 	void init();
+
+	[[nodiscard]]
+	const DeviceCaps& get_device_caps() noexcept;
 }
\ No newline at end of file
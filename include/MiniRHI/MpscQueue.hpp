@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <type_traits>
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	/*
+	* Unbounded lock-free multi-producer single-consumer queue (Vyukov's linked list with a stub node).
+	* push() may be called from any thread, try_pop() only from the consumer thread.
+	* A push that is still linking its node is invisible to try_pop() until it completes,
+	* the consumer simply picks it up on its next call.
+	*/
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	class MpscQueue {
+	public:
+		explicit MpscQueue() noexcept
+			: head_(&stub_)
+			, tail_(&stub_)
+		{}
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		MpscQueue(MpscQueue&&) = delete;
+		MpscQueue& operator=(MpscQueue&&) = delete;
+
+		~MpscQueue() noexcept {
+			T value{};
+			while (try_pop(value)) {}
+			if (tail_ != &stub_) {
+				delete tail_;
+			}
+		}
+
+		void push(const T& value) noexcept {
+			Node* node = new Node(value);
+			Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		[[nodiscard]]
+		bool try_pop(T& value) noexcept {
+			Node* tail = tail_;
+			Node* next = tail->next.load(std::memory_order_acquire);
+			if (next == nullptr) {
+				return false;
+			}
+
+			// next becomes the new stub, its value has been consumed.
+			value = next->value;
+			tail_ = next;
+			if (tail != &stub_) {
+				delete tail;
+			}
+			return true;
+		}
+
+	private:
+		struct Node {
+			explicit Node() noexcept = default;
+			explicit Node(const T& node_value) noexcept
+				: value(node_value)
+			{}
+
+			T value{};
+			std::atomic<Node*> next{ nullptr };
+		};
+
+		Node stub_;
+		std::atomic<Node*> head_;
+		// Only touched by the consumer
+		Node* tail_;
+	};
+}
@@ -27,9 +27,15 @@ namespace minirhi
 		eCount,
 	};
 
-	template<format::TFormat Fmt>
+	/*
+	* StepRate 0 makes the attribute per-vertex.
+	* Anything else makes it per-instance: it is sourced from the instance buffer 
+	* and advances once every StepRate instances.
+	*/
+	template<format::TFormat Fmt, u32 StepRate = 0>
 	struct VtxAttr {
 		using Type = Fmt;
+		static constexpr u32 kStepRate = StepRate;
 	};
 
 	template<typename...>
@@ -51,6 +57,7 @@ namespace minirhi
 		std::size_t size;
 		std::size_t offset;
 		std::size_t stride;
+		u32 step_rate;
 
 		auto operator<=>(const VtxAttrData&) const noexcept = default;
 	};
@@ -64,17 +71,31 @@ namespace minirhi
 		auto formats = std::to_array({
 			Attrs::Type::underlying()...
 		});
-		std::size_t stride = kGetVtxElemSize<VtxAttrArr<Attrs...>>;
+		auto step_rates = std::to_array<u32>({
+			Attrs::kStepRate...
+		});
+
+		// Per-vertex and per-instance attributes live in separate buffers, each one is packed on its own.
+		std::size_t vertex_stride = 0;
+		std::size_t instance_stride = 0;
+		for (std::size_t i = 0; i < sizeof...(Attrs); i++) {
+			(step_rates[i] == 0 ? vertex_stride : instance_stride) += sizes[i];
+		}
 
 		std::array<VtxAttrData, sizeof...(Attrs)> ret = {};
 
-		std::size_t offset = 0;
+		std::size_t vertex_offset = 0;
+		std::size_t instance_offset = 0;
 		for (std::size_t i = 0; i < sizeof...(Attrs); i++) {
+			const bool per_instance = step_rates[i] != 0;
+			std::size_t& offset = per_instance ? instance_offset : vertex_offset;
+
 			ret[i] = VtxAttrData {
 				.format = formats[i], 
 				.size = sizes[i], 
 				.offset = offset,
-				.stride = stride
+				.stride = per_instance ? instance_stride : vertex_stride,
+				.step_rate = step_rates[i]
 			};
 			offset += sizes[i];
 		}
@@ -87,6 +108,39 @@ namespace minirhi
 		return get_vtx_attr_array<Attrs...>();
 	}
 	
+	template<typename A, typename B>
+	struct ConcatVtxAttrArr;
+
+	template<typename... As, typename... Bs>
+	struct ConcatVtxAttrArr<VtxAttrArr<As...>, VtxAttrArr<Bs...>> {
+		using Type = VtxAttrArr<As..., Bs...>;
+	};
+
+	template<typename T, u32 StepRate>
+	struct WithStepRate;
+
+	// Turns per-vertex attributes into per-instance ones, already per-instance attributes keep their step rate.
+	template<typename... Attrs, u32 StepRate>
+	struct WithStepRate<VtxAttrArr<Attrs...>, StepRate> {
+		using Type = VtxAttrArr<VtxAttr<typename Attrs::Type, (Attrs::kStepRate == 0 ? StepRate : Attrs::kStepRate)>...>;
+	};
+
+	// Drops step rates, so layouts can be compared by formats only.
+	template<typename T>
+	struct StripStepRate;
+
+	template<typename... Attrs>
+	struct StripStepRate<VtxAttrArr<Attrs...>> {
+		using Type = VtxAttrArr<VtxAttr<typename Attrs::Type>...>;
+	};
+
+	/*
+	* One array per vertex layout type. 
+	* Its address identifies the layout at runtime, e.g. as a key of the VAO cache.
+	*/
+	template<typename Attrs>
+	inline constexpr auto kVtxAttrArray = get_vtx_attr_array(Attrs{});
+	
 	namespace tests {
 		static_assert(
 			get_vtx_attr_array<
@@ -94,8 +148,8 @@ namespace minirhi
 				VtxAttr<format::R32Float_t>
 			>() == 
 			std::array { 
-				VtxAttrData{ Format::eR16_Float, 2, 0, 6 }, 
-				VtxAttrData{ Format::eR32_Float, 4, 2, 6 } 
+				VtxAttrData{ Format::eR16_Float, 2, 0, 6, 0 }, 
+				VtxAttrData{ Format::eR32_Float, 4, 2, 6, 0 } 
 			}
 		);
 
@@ -107,11 +161,41 @@ namespace minirhi
 				>{}
 			) == 
 			std::array { 
-				VtxAttrData{ Format::eR16_Float, 2, 0, 6 }, 
-				VtxAttrData{ Format::eR32_Float, 4, 2, 6 } 
+				VtxAttrData{ Format::eR16_Float, 2, 0, 6, 0 }, 
+				VtxAttrData{ Format::eR32_Float, 4, 2, 6, 0 } 
 			}
 		);
 
+		static_assert(
+			get_vtx_attr_array<
+				VtxAttr<format::RGB32Float_t>, 
+				VtxAttr<format::RGBA32Float_t, 1>,
+				VtxAttr<format::RG32Float_t>,
+				VtxAttr<format::R32Float_t, 2>
+			>() == 
+			std::array { 
+				VtxAttrData{ Format::eRGB32_Float, 12, 0, 20, 0 }, 
+				VtxAttrData{ Format::eRGBA32_Float, 16, 0, 20, 1 }, 
+				VtxAttrData{ Format::eRG32_Float, 8, 12, 20, 0 }, 
+				VtxAttrData{ Format::eR32_Float, 4, 16, 20, 2 } 
+			}
+		);
+
+		static_assert(
+			std::same_as<
+				StripStepRate<
+					typename ConcatVtxAttrArr<
+						VtxAttrArr<VtxAttr<format::RGB32Float_t>>,
+						typename WithStepRate<VtxAttrArr<VtxAttr<format::RGBA32Float_t>>, 1>::Type
+					>::Type
+				>::Type,
+				VtxAttrArr<
+					VtxAttr<format::RGB32Float_t>,
+					VtxAttr<format::RGBA32Float_t>
+				>
+			>
+		);
+
 		static_assert(
 			kGetVtxElemSize<
 				VtxAttrArr<
@@ -195,15 +279,139 @@ namespace minirhi
 	template<FixedString Name>
 	using Mat4Slot = Slot<CTString<FixedString(glsl::TypeNames::kMat4)>, CTString<Name>>;
 
+	// Part of a uniform buffer bound to a uniform block slot with glBindBufferRange.
+	struct UniformBufferRange {
+		u32 handle = std::numeric_limits<u32>::max();
+		std::size_t offset = 0;
+		std::size_t size = 0;
+
+		[[nodiscard]]
+		bool is_valid() const noexcept {
+			return handle != std::numeric_limits<u32>::max();
+		}
+	};
+
+	// Slot type of a uniform block holding a T, T is checked against the block's std140 layout.
+	template<typename T>
+	struct UniformBlock {};
+
+	// Like UniformBlock, but the slot holds the T itself and DrawCtx copies it into a TransientUniformAllocator.
+	template<typename T>
+	struct TransientUniformBlock {};
+
+	// Slot type generated from a uniform block declaration, Body is the block body.
+	template<typename Body>
+	struct UniformBlockLayout {};
+
+	namespace detail {
+		/*
+		* The slot doesn't keep the buffer alive. 
+		* Buffers are accepted through get_uniform_buffer_range overloads, e.g. ConstantBufferRC or ConstantBufferView.
+		*/
+		struct UniformBlockSlot_ {
+			UniformBufferRange value{};
+
+			explicit constexpr UniformBlockSlot_() noexcept = default;
+			explicit constexpr UniformBlockSlot_(const UniformBufferRange& range) noexcept 
+				: value(range)
+			{}
+
+			template<typename Buffer> 
+				requires requires(const Buffer& buffer) { { get_uniform_buffer_range(buffer) } -> std::same_as<UniformBufferRange>; }
+			explicit UniformBlockSlot_(const Buffer& buffer) noexcept 
+				: value(get_uniform_buffer_range(buffer))
+			{}
+		};
+	}
+
+	template<typename T, typename Name>
+	struct Slot<UniformBlock<T>, Name> : detail::UniformBlockSlot_ {
+		using UniformBlockSlot_::UniformBlockSlot_;
+	};
+	template<FixedString Name, typename T>
+	using UniformBlockSlot = Slot<UniformBlock<T>, CTString<Name>>;
+
+	template<typename T, typename Name>
+	struct Slot<TransientUniformBlock<T>, Name> {
+		T value{};
+		// Allocation of value made by DrawCtx::set_bindings, reused while the slot is clean within the same frame.
+		mutable UniformBufferRange range{};
+		mutable u64 frame = std::numeric_limits<u64>::max();
+
+		explicit constexpr Slot() noexcept = default;
+		explicit constexpr Slot(const T& v) noexcept
+			: value(v)
+		{}
+	};
+	template<FixedString Name, typename T>
+	using TransientUniformBlockSlot = Slot<TransientUniformBlock<T>, CTString<Name>>;
+
+	template<typename Body, typename Name>
+	struct Slot<UniformBlockLayout<Body>, Name> : detail::UniformBlockSlot_ {
+		using UniformBlockSlot_::UniformBlockSlot_;
+	};
+
+	template<typename T>
+	struct SlotTraits;
+
+	template<typename Type, typename Name>
+	struct SlotTraits<Slot<Type, Name>> {
+		static constexpr std::string_view kName = Name::kValue;
+		static constexpr bool kIsUniformBlock = false;
+		static constexpr bool kIsTransient = false;
+	};
+
+	template<typename T, typename Name>
+	struct SlotTraits<Slot<UniformBlock<T>, Name>> {
+		static constexpr std::string_view kName = Name::kValue;
+		static constexpr bool kIsUniformBlock = true;
+		static constexpr bool kIsTransient = false;
+	};
+
+	template<typename T, typename Name>
+	struct SlotTraits<Slot<TransientUniformBlock<T>, Name>> {
+		static constexpr std::string_view kName = Name::kValue;
+		static constexpr bool kIsUniformBlock = true;
+		static constexpr bool kIsTransient = true;
+	};
+
+	template<typename Body, typename Name>
+	struct SlotTraits<Slot<UniformBlockLayout<Body>, Name>> {
+		static constexpr std::string_view kName = Name::kValue;
+		static constexpr bool kIsUniformBlock = true;
+		static constexpr bool kIsTransient = false;
+	};
+
 	template<typename... Slots>
 	struct BindingSet {
 		using Tuple = std::tuple<Slots...>;
 		static constexpr std::size_t kSlotCount = sizeof...(Slots);
 		static constexpr bool kIsEmpty = kSlotCount == 0;
+		// Uniform names in slot order. Each one is null-terminated, so they can be passed to GL as is.
+		static constexpr std::array<std::string_view, kSlotCount> kSlotNames = { SlotTraits<Slots>::kName... };
+		static constexpr std::array<bool, kSlotCount> kUniformBlockSlots = { SlotTraits<Slots>::kIsUniformBlock... };
+		static constexpr bool kHasTransientSlots = (SlotTraits<Slots>::kIsTransient || ... || false);
+		static_assert(kSlotCount <= 64, "minirhi::BindingSet supports up to 64 slots!");
+
+		template<typename T>
+		static constexpr std::size_t kSlotIndex = [] {
+			constexpr std::array<bool, kSlotCount> kMatches = { std::same_as<T, Slots>... };
+			return std::size_t(std::ranges::find(kMatches, true) - kMatches.begin());
+		}();
+
 		Tuple slots{};
 
+		/*
+		* Dirty tracking used by DrawCtx::set_bindings. 
+		* Every non-const slot access marks the slot as dirty, writing to `slots` directly bypasses it.
+		*/
+		u64 dirty_mask = ~u64(0);
+		u32 applied_program = kShaderInvalidHandle;
+		u64 applied_epoch = 0;
+
 		template<typename T>
 		auto& get_slot() noexcept {
+			dirty_mask |= u64(1) << kSlotIndex<T>;
 			return std::get<T>(slots);
 		}
 
@@ -228,6 +436,26 @@ const Type<Uniform>& get_##Name##_slot() const noexcept { \
 		MINIRHI_DECLARE_BINDING_SLOT_GETTER_INLINED_(UIntSlot, uint);
 		MINIRHI_DECLARE_BINDING_SLOT_GETTER_INLINED_(FloatSlot, float);
 
+		template<FixedString Block, typename T>
+		UniformBlockSlot<Block, T>& get_uniform_block_slot() noexcept {
+			return get_slot<UniformBlockSlot<Block, T>>();
+		}
+
+		template<FixedString Block, typename T>
+		const UniformBlockSlot<Block, T>& get_uniform_block_slot() const noexcept {
+			return get_slot<UniformBlockSlot<Block, T>>();
+		}
+
+		template<FixedString Block, typename T>
+		TransientUniformBlockSlot<Block, T>& get_transient_uniform_block_slot() noexcept {
+			return get_slot<TransientUniformBlockSlot<Block, T>>();
+		}
+
+		template<FixedString Block, typename T>
+		const TransientUniformBlockSlot<Block, T>& get_transient_uniform_block_slot() const noexcept {
+			return get_slot<TransientUniformBlockSlot<Block, T>>();
+		}
+
 	};
 
 	template<typename... Slots>
@@ -239,6 +467,16 @@ const Type<Uniform>& get_##Name##_slot() const noexcept { \
 
 	inline static constexpr auto kEmptyBindings = make_bindings();
 
+	namespace tests {
+		static_assert(
+			BindingSet<Mat4Slot<"model">, FloatSlot<"time">>::kSlotNames == 
+			std::array{ std::string_view("model"), std::string_view("time") }
+		);
+		static_assert(BindingSet<Mat4Slot<"model">>::kSlotNames[0].data()[5] == '\0');
+		static_assert(BindingSet<Mat4Slot<"model">, FloatSlot<"time">>::kSlotIndex<FloatSlot<"time">> == 1);
+		static_assert(BindingSet<Mat4Slot<"model">, UniformBlockSlot<"Camera", glm::mat4>>::kUniformBlockSlots == std::array{ false, true });
+	}
+
 	namespace detail {
 		template<FixedString Code>
 		consteval auto get_input_layout_tuple() {
@@ -312,6 +550,15 @@ void main() {
 			);
 		}
 
+		template<typename TypeStr, typename NameStr>
+		struct MakeSlot_ {
+			using Type = std::conditional_t<
+				::minirhi::glsl::is_uniform_block(TypeStr::kValue), 
+				Slot<UniformBlockLayout<TypeStr>, NameStr>, 
+				Slot<TypeStr, NameStr>
+			>;
+		};
+
 		template<typename T>
 		struct ConvertToBindingSet;
 
@@ -337,10 +584,10 @@ void main() {
 
 			constexpr auto kTuple = [&]<std::size_t... Ns>(std::index_sequence<Ns...>) {
 				return std::make_tuple(
-					Slot<
+					typename MakeSlot_<
 						CTString<FixedString<kUniforms[Ns].first.size()>(kUniforms[Ns].first)>,
 						CTString<FixedString<kUniforms[Ns].second.size()>(kUniforms[Ns].second)>
-					>{}...
+					>::Type{}...
 				);
 			}(std::make_index_sequence<kUniforms.size()>{});
 
@@ -413,32 +660,32 @@ void main() {
 			, line_width(width)
 		{}
 
-		RasterizerStateDesc& set_polygon_mode(PolygonMode mode) noexcept {
+		constexpr RasterizerStateDesc& set_polygon_mode(PolygonMode mode) noexcept {
 			polygon_mode = mode;
 			return *this;
 		}
 
-		RasterizerStateDesc& enable_cull_mode(bool enable) noexcept {
+		constexpr RasterizerStateDesc& enable_cull_mode(bool enable) noexcept {
 			cull_mode_enabled = enable;
 			return *this;
 		}
 
-		RasterizerStateDesc& set_front_face(FrontFace front_face) noexcept {
+		constexpr RasterizerStateDesc& set_front_face(FrontFace front_face) noexcept {
 			front = front_face;
 			return *this;
 		}
 
-		RasterizerStateDesc& set_cull_face(CullFaceMode mode) noexcept {
+		constexpr RasterizerStateDesc& set_cull_face(CullFaceMode mode) noexcept {
 			cull_mode = mode;
 			return *this;
 		}
 
-		RasterizerStateDesc& set_line_width(f32 width) noexcept {
+		constexpr RasterizerStateDesc& set_line_width(f32 width) noexcept {
 			line_width = width;
 			return *this;
 		}
 
-		RasterizerStateDesc& enable_line_smooth(bool enable) noexcept {
+		constexpr RasterizerStateDesc& enable_line_smooth(bool enable) noexcept {
 			line_smooth_enabled = enable;
 			return *this;
 		}
@@ -490,26 +737,36 @@ void main() {
 			} state;
 		};
 		static_assert(sizeof(GraphicsPipelineRaw) == sizeof(u64));
+
+		[[nodiscard]]
+		constexpr GraphicsPipelineRaw make_pipeline_raw_(PrimitiveTopologyType topology, const DepthStencilDesc& depth_stencil, const RasterizerStateDesc& rasterizer, u32 program) noexcept {
+			return GraphicsPipelineRaw{ .state = {
+				.topology = u32(topology),
+				.enable_depth = u32(depth_stencil.enable_depth),
+				.depth_mask = u32(depth_stencil.depth_mask),
+				.depth_fn = u32(depth_stencil.depth_func),
+				.front_face = u32(rasterizer.front),
+				.cull_mode_enabled = u32(rasterizer.cull_mode_enabled),
+				.line_smooth_enabled = u32(rasterizer.line_smooth_enabled),
+				.cull_mode = u32(rasterizer.cull_mode),
+				.polygon_mode = u32(rasterizer.polygon_mode),
+				.padding = 0,
+				.program = program,
+			} };
+		}
 	}
 
 	template<typename Attrs, typename BS>
 	struct GraphicsPipeline {
 		detail::GraphicsPipelineRaw raw;
+		// Uniform locations of the BS slots, indexed by slot position.
+		std::array<i32, BS::kSlotCount> locations{};
 
 		explicit  GraphicsPipeline() noexcept = default;
 
-		explicit GraphicsPipeline(const GraphicsPipelineDesc<Attrs, BS>& desc, u32 program) noexcept {
-			raw.state.program = program;
-			raw.state.topology = u32(desc.topology);
-			raw.state.enable_depth = u32(desc.depth_stencil.enable_depth);
-			raw.state.depth_mask = u32(desc.depth_stencil.depth_mask);
-			raw.state.depth_fn = u32(desc.depth_stencil.depth_func);
-			raw.state.front_face = u32(desc.rasterizer.front);
-			raw.state.cull_mode_enabled = u32(desc.rasterizer.cull_mode_enabled);
-			raw.state.line_smooth_enabled = u32(desc.rasterizer.line_smooth_enabled);
-			raw.state.cull_mode = u32(desc.rasterizer.cull_mode);
-			raw.state.polygon_mode = u32(desc.rasterizer.polygon_mode);
-		}
+		explicit GraphicsPipeline(const GraphicsPipelineDesc<Attrs, BS>& desc, u32 program) noexcept 
+			: raw(detail::make_pipeline_raw_(desc.topology, desc.depth_stencil, desc.rasterizer, program))
+		{}
 
 		template<typename OtherAttrs, typename OtherBS>
 		bool operator==(GraphicsPipeline<OtherAttrs, OtherBS> other) const noexcept {
@@ -574,7 +831,10 @@ void main() {
 				ShaderCompiler::destroy_shaders(vs, fs);
 			}
 
-			return GraphicsPipeline(*this, shader_program);
+			GraphicsPipeline<Attrs, BS> pipeline(*this, shader_program);
+			ShaderCompiler::get_uniform_locations(shader_program, BS::kSlotNames, pipeline.locations);
+			ShaderCompiler::get_uniform_block_bindings(shader_program, BS::kSlotNames, BS::kUniformBlockSlots, pipeline.locations);
+			return pipeline;
 		}
 	};
 
@@ -592,4 +852,52 @@ void main() {
 		};
 		return pipeline.build(true);
 	}
+
+	// Fixed function state of a pipeline, known at compile time.
+	struct StaticPipelineState {
+		PrimitiveTopologyType topology = PrimitiveTopologyType::eTriangle;
+		DepthStencilDesc depth_stencil{};
+		RasterizerStateDesc rasterizer{};
+	};
+
+	/*
+	* A GraphicsPipeline whose fixed function state is part of its type, only the program is picked at runtime.
+	* Works everywhere a GraphicsPipeline does, CmdCtx::transition uses the state to switch between
+	* two such pipelines with only the GL calls that differ.
+	*/
+	template<typename Attrs, typename BS, StaticPipelineState State>
+	struct StaticGraphicsPipeline : GraphicsPipeline<Attrs, BS> {
+		using Attributes = Attrs;
+		using Bindings = BS;
+
+		static constexpr StaticPipelineState kState = State;
+		// Raw state without a program.
+		static constexpr detail::GraphicsPipelineRaw kRaw = detail::make_pipeline_raw_(State.topology, State.depth_stencil, State.rasterizer, 0);
+
+		explicit StaticGraphicsPipeline() noexcept = default;
+
+		explicit StaticGraphicsPipeline(const GraphicsPipeline<Attrs, BS>& pipeline) noexcept 
+			: GraphicsPipeline<Attrs, BS>(pipeline)
+		{
+			assert(detail::make_pipeline_raw_(State.topology, State.depth_stencil, State.rasterizer, this->raw.state.program).dummy_ == this->raw.dummy_);
+		}
+	};
+
+	template<typename T>
+	concept TStaticGraphicsPipeline = std::same_as<T, StaticGraphicsPipeline<typename T::Attributes, typename T::Bindings, T::kState>>;
+
+	template<FixedString VS, FixedString FS, StaticPipelineState State>
+	inline auto generate_static_graphics_pipeline_from_shaders() noexcept {
+		using Attrs = decltype(detail::generate_input_layout<VS>());
+		using BS = decltype(detail::generate_binding_set<VS, FS>());
+
+		GraphicsPipelineDesc<Attrs, BS> pipeline {
+			ShaderCompiler::compile_from_code<VtxShaderHandle>(VS),
+			ShaderCompiler::compile_from_code<FragShaderHandle>(FS),
+			State.topology,
+			State.depth_stencil,
+			State.rasterizer
+		};
+		return StaticGraphicsPipeline<Attrs, BS, State>(pipeline.build(true));
+	}
 }
\ No newline at end of file
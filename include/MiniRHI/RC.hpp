@@ -1,24 +1,179 @@
 #pragma once
+#include <atomic>
 #include <concepts>
 #include <cassert>
+#include <memory>
+#include <new>
+
+#include "MiniRHI/DeletionQueue.hpp"
 
 #include <Core/Core.hpp>
 #include <type_traits>
 
 namespace minirhi {
-	template<typename Res, auto Destroy = Res::destroy>
-		requires std::is_trivially_copyable_v<Res> && std::invocable<decltype(Destroy), Res&>
+	// Plain counter, for handles that are only copied on one thread at a time.
+	struct LocalRefCount {
+		using Count = size_t;
+
+		static constexpr void increment(Count& count) noexcept {
+			++count;
+		}
+
+		// Returns true when the last reference went away.
+		static constexpr bool decrement(Count& count) noexcept {
+			return --count == 0u;
+		}
+
+		static constexpr size_t load(const Count& count) noexcept {
+			return count;
+		}
+	};
+
+	// Atomic counter, for handles shared between threads (e.g. a loader and the render thread).
+	struct AtomicRefCount {
+		using Count = std::atomic<size_t>;
+
+		static void increment(Count& count) noexcept {
+			count.fetch_add(1u, std::memory_order_relaxed);
+		}
+
+		static bool decrement(Count& count) noexcept {
+			if (count.fetch_sub(1u, std::memory_order_release) != 1u) {
+				return false;
+			}
+			// Everything other owners did with the resource happens before it is destroyed.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return true;
+		}
+
+		static size_t load(const Count& count) noexcept {
+			return count.load(std::memory_order_relaxed);
+		}
+	};
+
+	template<typename Policy>
+	concept TRefCountPolicy = requires(typename Policy::Count& count) {
+		Policy::increment(count);
+		{ Policy::decrement(count) } -> std::same_as<bool>;
+		{ Policy::load(count) } -> std::same_as<size_t>;
+	};
+
+	namespace detail {
+		/*
+		* Free list of reference counts carved out of slabs, so creating an RC doesn't go through malloc.
+		* Slabs are never given back, counts released during static destruction stay valid.
+		* The spin lock is only taken when an RC is created or its last reference goes away.
+		*/
+		template<typename Count>
+		class RefCountPool {
+		public:
+			static constexpr size_t kSlotsPerSlab = 512;
+
+			[[nodiscard]]
+			Count* allocate() noexcept {
+				lock_();
+				if (free_ == nullptr) {
+					grow_();
+				}
+				Slot* slot = free_;
+				free_ = slot->next;
+				unlock_();
+
+				return ::new (static_cast<void*>(slot)) Count(1u);
+			}
+
+			void free(Count* count) noexcept {
+				count->~Count();
+				Slot* slot = ::new (static_cast<void*>(count)) Slot{};
+
+				lock_();
+				slot->next = free_;
+				free_ = slot;
+				unlock_();
+			}
+
+		private:
+			union Slot {
+				Slot* next;
+				alignas(Count) std::byte storage[sizeof(Count)];
+			};
+
+			void grow_() noexcept {
+				Slot* slab = new Slot[kSlotsPerSlab];
+				for (size_t i = 0; i + 1 < kSlotsPerSlab; i++) {
+					slab[i].next = &slab[i + 1];
+				}
+				slab[kSlotsPerSlab - 1].next = nullptr;
+				free_ = slab;
+			}
+
+			void lock_() noexcept {
+				while (lock_flag_.test_and_set(std::memory_order_acquire)) {
+					while (lock_flag_.test(std::memory_order_relaxed)) {}
+				}
+			}
+
+			void unlock_() noexcept {
+				lock_flag_.clear(std::memory_order_release);
+			}
+
+			std::atomic_flag lock_flag_{};
+			Slot* free_ = nullptr;
+		};
+
+		template<typename Count>
+		inline constinit RefCountPool<Count> gRefCountPool{};
+	}
+
+	template<typename Res, auto Destroy = Res::destroy, typename Policy = LocalRefCount>
+		requires std::is_trivially_copyable_v<Res> && std::invocable<decltype(Destroy), Res&> && TRefCountPolicy<Policy>
 	class RC {
 	private:
-		size_t* ref_count_ = nullptr;
+		using Count = typename Policy::Count;
+
+		Count* ref_count_ = nullptr;
 		Res _handle;
 
+		[[nodiscard]]
+		static constexpr Count* allocate_count_() noexcept {
+			if (std::is_constant_evaluated()) {
+				return new Count(1u);
+			}
+			return detail::gRefCountPool<Count>.allocate();
+		}
+
+		static constexpr void free_count_(Count* count) noexcept {
+			if (std::is_constant_evaluated()) {
+				delete count;
+				return;
+			}
+			detail::gRefCountPool<Count>.free(count);
+		}
+
+		// Drops this reference, destroying the resource if it was the last one.
+		constexpr void release_() noexcept {
+			if (ref_count_ == nullptr) {
+				return;
+			}
+			if (Policy::decrement(*ref_count_)) {
+				if constexpr (std::same_as<Policy, AtomicRefCount>) {
+					// Without a DeletionQueue the destroy runs glDelete* right here, possibly on a thread without a GL context.
+					assert(detail::is_deferring_deletions_() && "AtomicRC released without an active DeletionQueue!");
+				}
+				Destroy(_handle);
+				free_count_(ref_count_);
+			}
+			ref_count_ = nullptr;
+		}
+
 	public:
 		explicit constexpr RC() noexcept = default;
 
+		// Constructs the resource in place. A single RC argument is left to the copy and move constructors.
 		template<typename... Args> requires std::bool_constant<sizeof...(Args) != 0>::value
+			&& (!std::conjunction_v<std::bool_constant<sizeof...(Args) == 1>, std::is_same<std::remove_cvref_t<Args>, RC>...>)
 		explicit constexpr RC(Args&&... args) noexcept
-			: ref_count_(new size_t(1u))
+			: ref_count_(allocate_count_())
 			, _handle(std::forward<Args>(args)...)
 		{}
 
@@ -30,7 +185,7 @@ namespace minirhi {
 			if (!std::is_constant_evaluated()) {
 				assert(rhs.ref_count_ != nullptr && "Cannot copy invalid RC object.");
 			}
-			++(*ref_count_);
+			Policy::increment(*ref_count_);
 		}
 
 		constexpr RC& operator=(const RC& rhs) noexcept {
@@ -38,16 +193,13 @@ namespace minirhi {
 				return *this;
 			}
 
-			if (ref_count_ != nullptr) {
-				--(*ref_count_);
-			}
-			
 			if (!std::is_constant_evaluated()) {
 				assert(rhs.ref_count_ != nullptr && "Cannot copy invalid RC object.");
 			}
 
+			Policy::increment(*rhs.ref_count_);
+			release_();
 			ref_count_ = rhs.ref_count_;
-			++(*ref_count_);
 
 			_handle = rhs._handle;
 
@@ -71,16 +223,14 @@ namespace minirhi {
 			if (!std::is_constant_evaluated()) {
 				assert(rhs.ref_count_ != nullptr && "Cannot move invalid RC object.");
 			}
-			
+
+			// Both share the count, rhs gives its reference up and this one keeps its own.
 			if (ref_count_ == rhs.ref_count_) {
-				--(*ref_count_);
-				rhs.ref_count_ = nullptr;
+				rhs.release_();
 				return *this;
 			}
 
-			if (ref_count_ != nullptr) {
-				--(*ref_count_);
-			}
+			release_();
 			ref_count_ = rhs.ref_count_;
 			_handle = std::move(rhs._handle);
 
@@ -90,17 +240,7 @@ namespace minirhi {
 		}
 
 		constexpr ~RC() noexcept {
-			if (ref_count_ == nullptr) {
-				return;
-			}
-
-			--(*ref_count_);
-
-			if (*ref_count_ == 0u) {
-				Destroy(_handle);
-				delete ref_count_;
-			}
-			ref_count_ = nullptr;
+			release_();
 		}
 
 		Res* operator->() noexcept {
@@ -110,24 +250,14 @@ namespace minirhi {
 
 		template<typename... Args> requires std::bool_constant<sizeof...(Args) != 0>::value
 		constexpr void reset(Args&&... args) noexcept {
-			::new (&_handle) Res{ std::forward<Args>(args)... };
-
-			if (ref_count_ != nullptr) {
-				if (*ref_count_ == 1u)
-				{
-					delete ref_count_;
-				}
-				else
-				{
-					--(*ref_count_);
-				}
-			}
-			ref_count_ = new size_t(1u);
+			release_();
+			std::construct_at(&_handle, Res{ std::forward<Args>(args)... });
+			ref_count_ = allocate_count_();
 		}
 
-		[[nodiscard]] 
+		[[nodiscard]]
 		constexpr size_t get_ref_count() const noexcept {
-			return ref_count_ != nullptr ? *ref_count_ : 0u;
+			return ref_count_ != nullptr ? Policy::load(*ref_count_) : 0u;
 		}
 
 		[[nodiscard]]
@@ -140,9 +270,42 @@ namespace minirhi {
 			return _handle;
 		}
 
-		[[nodiscard]] 
+		[[nodiscard]]
 		constexpr bool is_empty() const noexcept {
 			return ref_count_ == nullptr;
 		}
 	};
-}
\ No newline at end of file
+
+	/*
+	* RC that can be copied and released on several threads at once, e.g. AtomicRC<Texture>.
+	* The last release destroys the resource on whichever thread it happens, so a DeletionQueue
+	* (or a FramePacer, which owns one) has to be active: destruction then only queues the handle
+	* and the GL thread deletes it. Releasing the last reference without one asserts.
+	*/
+	template<typename Res, auto Destroy = Res::destroy>
+	using AtomicRC = RC<Res, Destroy, AtomicRefCount>;
+
+	namespace tests {
+		struct RefCountTestResource {
+			u32 handle = 0;
+
+			static constexpr void destroy(RefCountTestResource& res) noexcept {
+				res.handle = 0;
+			}
+		};
+
+		consteval bool test_ref_count() {
+			RC<RefCountTestResource> a{ 1u };
+			RC<RefCountTestResource> b = a;
+			RC<RefCountTestResource> c{ 2u };
+			c = b;
+			const bool shared = a.get_ref_count() == 3u && c.get().handle == 1u;
+
+			RC<RefCountTestResource> d = std::move(c);
+			b.reset(3u);
+			return shared && c.is_empty() && d.get_ref_count() == 2u && b.get_ref_count() == 1u;
+		}
+
+		static_assert(test_ref_count());
+	}
+}
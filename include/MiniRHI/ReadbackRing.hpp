@@ -0,0 +1,112 @@
+#pragma once
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "MiniRHI/Fence.hpp"
+#include "MiniRHI/Format.hpp"
+#include "MiniRHI/Framebuffer.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	// Origin is the bottom left corner, like glReadPixels.
+	struct ReadbackRect {
+		u32 x = 0;
+		u32 y = 0;
+		u32 width = 0;
+		u32 height = 0;
+	};
+
+	// Refers to a slot of the ring, becomes stale once the slot is released.
+	struct ReadbackRequest {
+		u32 slot = std::numeric_limits<u32>::max();
+		u64 serial = 0;
+
+		[[nodiscard]]
+		bool is_valid() const noexcept {
+			return slot != std::numeric_limits<u32>::max();
+		}
+	};
+
+	/*
+	* Asynchronous glReadPixels into a ring of pixel pack buffers.
+	* Every read occupies a slot and is followed by a fence. Poll is_ready() for a few frames,
+	* then map() the pixels and release() the slot. Nothing waits on the GPU unless map() is called early.
+	* Rows are tightly packed, bottom row first. GLES only guarantees RGBA8 (Format::eRGBA8_UInt) for color reads.
+	*/
+	class ReadbackRing {
+	public:
+		explicit ReadbackRing() noexcept = default;
+		explicit ReadbackRing(u32 slot_count) noexcept;
+
+		ReadbackRing(const ReadbackRing&) = delete;
+		ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+		ReadbackRing(ReadbackRing&& rhs) noexcept;
+		ReadbackRing& operator=(ReadbackRing&& rhs) noexcept;
+
+		~ReadbackRing() noexcept;
+
+		// Reads a color attachment of fb, or its depth attachment for depth formats. Returns an invalid request if every slot is in use.
+		[[nodiscard]]
+		ReadbackRequest read_pixels_async(const Framebuffer& fb, const ReadbackRect& rect, Format format, u32 attachment = 0) noexcept {
+			return read_(fb.handle, rect, format, attachment);
+		}
+
+		[[nodiscard]]
+		ReadbackRequest read_pixels_async(const RenderTarget& target, const ReadbackRect& rect, Format format, u32 attachment = 0) noexcept {
+			return read_(target.get().handle, rect, format, attachment);
+		}
+
+		// Reads the back buffer of the default framebuffer.
+		[[nodiscard]]
+		ReadbackRequest read_pixels_async(const ReadbackRect& rect, Format format) noexcept {
+			return read_(0, rect, format, 0);
+		}
+
+		[[nodiscard]]
+		bool is_ready(const ReadbackRequest& request) const noexcept;
+
+		// Waits for the read if it isn't ready yet. The span stays valid until the request is released.
+		[[nodiscard]]
+		std::span<const u8> map(const ReadbackRequest& request) noexcept;
+
+		// Unmaps the pixels and frees the slot, request is reset.
+		void release(ReadbackRequest& request) noexcept;
+
+		[[nodiscard]]
+		u32 slot_count() const noexcept {
+			return u32(slots_.size());
+		}
+
+	private:
+		enum class SlotState : u8 {
+			eFree = 0,
+			ePending,
+			eMapped,
+		};
+
+		struct Slot {
+			u32 buffer = 0;
+			std::size_t capacity = 0;
+			std::size_t size = 0;
+			Fence fence{};
+			u64 serial = 0;
+			SlotState state = SlotState::eFree;
+			const u8* mapped = nullptr;
+		};
+
+		ReadbackRequest read_(u32 framebuffer, const ReadbackRect& rect, Format format, u32 attachment) noexcept;
+
+		// Index of the slot the request refers to, or the slot count for stale requests.
+		[[nodiscard]]
+		std::size_t find_slot_(const ReadbackRequest& request) const noexcept;
+
+		void release_() noexcept;
+
+		std::vector<Slot> slots_;
+		u32 next_slot_ = 0;
+		u64 serial_ = 0;
+	};
+}
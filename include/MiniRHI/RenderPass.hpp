@@ -0,0 +1,152 @@
+#pragma once
+#include "MiniRHI/CmdCtx.hpp"
+#include "MiniRHI/Framebuffer.hpp"
+
+#include <array>
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	enum class LoadOp : u8 {
+		eLoad = 0,
+		eClear,
+		// Previous contents are undefined, tilers skip loading them
+		eDontCare,
+	};
+
+	enum class StoreOp : u8 {
+		eStore = 0,
+		// Contents are undefined after the pass, tilers skip writing them back
+		eDiscard,
+	};
+
+	struct ColorAttachmentOps {
+		LoadOp load = LoadOp::eLoad;
+		StoreOp store = StoreOp::eStore;
+		std::array<f32, 4> clear_color{ 0.f, 0.f, 0.f, 1.f };
+	};
+
+	struct DepthStencilAttachmentOps {
+		LoadOp depth_load = LoadOp::eLoad;
+		StoreOp depth_store = StoreOp::eStore;
+		f32 clear_depth = 1.f;
+
+		LoadOp stencil_load = LoadOp::eLoad;
+		StoreOp stencil_store = StoreOp::eStore;
+		i32 clear_stencil = 0;
+	};
+
+	struct RenderPassDesc {
+		std::array<ColorAttachmentOps, kMaxColorAttachments> colors{};
+		DepthStencilAttachmentOps depth_stencil{};
+
+		RenderPassDesc& set_color(u32 attachment, const ColorAttachmentOps& ops) noexcept {
+			assert(attachment < kMaxColorAttachments);
+			colors[attachment] = ops;
+			return *this;
+		}
+
+		RenderPassDesc& set_depth_stencil(const DepthStencilAttachmentOps& ops) noexcept {
+			depth_stencil = ops;
+			return *this;
+		}
+	};
+
+	/*
+	* Applies load ops when constructed and store ops when it ends.
+	* All clears of the pass are merged into a single glClear where possible,
+	* don't care and discarded attachments are passed to glInvalidateFramebuffer if the device supports it.
+	* Draw contexts are started from the pass and have to finish before it ends.
+	*/
+	class [[nodiscard]] RenderPass {
+	public:
+		// Pass over the default framebuffer, which is assumed to have a depth-stencil buffer.
+		explicit RenderPass(const Viewport& vp, const RenderPassDesc& desc) noexcept
+			: framebuffer_()
+			, viewport_(vp)
+			, desc_(desc)
+			, color_count_(1)
+			, has_depth_(true)
+			, has_stencil_(true)
+			, is_default_(true)
+		{
+			begin_();
+		}
+
+		explicit RenderPass(const Framebuffer& fb, const RenderPassDesc& desc) noexcept
+			: framebuffer_(fb)
+			, viewport_(fb.desc.width, fb.desc.height)
+			, desc_(desc)
+			, color_count_(fb.desc.color_attachment_count)
+			, has_depth_(fb.desc.depth_stencil_attachment != kInvalidTextureHandle)
+			, has_stencil_(has_stencil(fb.desc.depth_stencil_format))
+			, is_default_(false)
+		{
+			assert(fb.is_valid());
+			begin_();
+		}
+
+		RenderPass(const RenderPass&) = delete;
+		RenderPass& operator=(const RenderPass&) = delete;
+
+		RenderPass(RenderPass&& rhs) noexcept
+			: framebuffer_(rhs.framebuffer_)
+			, viewport_(rhs.viewport_)
+			, desc_(rhs.desc_)
+			, color_count_(rhs.color_count_)
+			, has_depth_(rhs.has_depth_)
+			, has_stencil_(rhs.has_stencil_)
+			, is_default_(rhs.is_default_)
+			, is_active_(rhs.is_active_)
+		{
+			rhs.is_active_ = false;
+		}
+
+		RenderPass& operator=(RenderPass&&) = delete;
+
+		~RenderPass() noexcept {
+			end();
+		}
+
+		template<typename Attrs, typename BS>
+		[[nodiscard]]
+		DrawCtx<Attrs, BS> start_draw_context(GraphicsPipeline<Attrs, BS> ps) const noexcept {
+			return start_draw_context(viewport_, ps);
+		}
+
+		template<typename Attrs, typename BS>
+		[[nodiscard]]
+		DrawCtx<Attrs, BS> start_draw_context(const Viewport& vp, GraphicsPipeline<Attrs, BS> ps) const noexcept {
+			assert(is_active_);
+			if (is_default_) {
+				return CmdCtx::start_draw_context(vp, ps);
+			}
+			return CmdCtx::start_draw_context(framebuffer_, vp, ps);
+		}
+
+		// Applies the store ops, called by the destructor if the pass hasn't ended yet.
+		void end() noexcept;
+
+		[[nodiscard]]
+		const Viewport& viewport() const noexcept {
+			return viewport_;
+		}
+
+	private:
+		void begin_() noexcept;
+
+		[[nodiscard]]
+		u32 get_framebuffer_handle_() const noexcept {
+			return is_default_ ? 0 : framebuffer_.handle;
+		}
+
+		Framebuffer framebuffer_;
+		Viewport viewport_;
+		RenderPassDesc desc_;
+		u32 color_count_;
+		bool has_depth_;
+		bool has_stencil_;
+		bool is_default_;
+		bool is_active_ = true;
+	};
+}
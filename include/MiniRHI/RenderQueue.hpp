@@ -0,0 +1,151 @@
+#pragma once
+#include <bit>
+#include <vector>
+
+#include "MiniRHI/CommandList.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	struct DrawSortDesc {
+		// Groups draws sharing textures and buffers, only the low kMaterialBits are used.
+		u32 material = 0;
+		// Distance from the camera, negative values are clamped to 0.
+		f32 depth = 0.f;
+		bool translucent = false;
+	};
+
+	/*
+	* 64-bit sort key, compared as an unsigned integer.
+	* Opaque:      [63] 0 | [62:51] program | [50:38] state | [37:24] material | [23:0] depth
+	* Translucent: [63] 1 | [62:39] far-to-near depth | [38:27] program | [26:14] state | [13:0] material
+	* Opaque draws come first, grouped by program, state and material, front-to-back inside a group for early-Z.
+	* Translucent draws come last and back-to-front, since blending order matters more than state switches.
+	*/
+	namespace sort_key {
+		inline constexpr u32 kProgramBits = 12;
+		inline constexpr u32 kStateBits = 13;
+		inline constexpr u32 kMaterialBits = 14;
+		inline constexpr u32 kDepthBits = 24;
+		static_assert(1 + kProgramBits + kStateBits + kMaterialBits + kDepthBits == 64);
+
+		[[nodiscard]]
+		constexpr u64 mask_(u32 bits) noexcept {
+			return (u64(1) << bits) - 1;
+		}
+
+		// Pipeline state without the program, in the bit-field order of GraphicsPipelineRaw.
+		[[nodiscard]]
+		constexpr u64 get_state_bits(detail::GraphicsPipelineRaw raw) noexcept {
+			return u64(raw.state.topology)
+				| u64(raw.state.enable_depth) << 2
+				| u64(raw.state.depth_mask) << 3
+				| u64(raw.state.depth_fn) << 4
+				| u64(raw.state.front_face) << 7
+				| u64(raw.state.cull_mode_enabled) << 8
+				| u64(raw.state.line_smooth_enabled) << 9
+				| u64(raw.state.cull_mode) << 10
+				| u64(raw.state.polygon_mode) << 11;
+		}
+
+		// Bit patterns of non-negative floats are ordered like their values, the top 24 bits below the sign are kept.
+		[[nodiscard]]
+		constexpr u64 quantize_depth(f32 depth) noexcept {
+			return u64(std::bit_cast<u32>(depth > 0.f ? depth : 0.f) >> (31 - kDepthBits)) & mask_(kDepthBits);
+		}
+
+		[[nodiscard]]
+		constexpr u64 make(detail::GraphicsPipelineRaw raw, const DrawSortDesc& desc) noexcept {
+			const u64 program = u64(raw.state.program) & mask_(kProgramBits);
+			const u64 state = get_state_bits(raw) & mask_(kStateBits);
+			const u64 material = u64(desc.material) & mask_(kMaterialBits);
+			const u64 depth = quantize_depth(desc.depth);
+
+			if (!desc.translucent) {
+				return program << (kStateBits + kMaterialBits + kDepthBits)
+					| state << (kMaterialBits + kDepthBits)
+					| material << kDepthBits
+					| depth;
+			}
+			return u64(1) << 63
+				| (mask_(kDepthBits) - depth) << (kProgramBits + kStateBits + kMaterialBits)
+				| program << (kStateBits + kMaterialBits)
+				| state << kMaterialBits
+				| material;
+		}
+	}
+
+	/*
+	* Collects draws in any order and replays them sorted by sort_key::make.
+	* Every add() starts an item: the pipeline setup plus everything recorded with the returned recorder
+	* until the next add(). Items with equal keys keep their submission order.
+	* Same lifetime rules as CommandList: resources must stay alive until the queue is submitted.
+	*/
+	class RenderQueue {
+	public:
+		explicit RenderQueue() noexcept = default;
+
+		RenderQueue(const RenderQueue&) = delete;
+		RenderQueue& operator=(const RenderQueue&) = delete;
+
+		RenderQueue(RenderQueue&&) noexcept = default;
+		RenderQueue& operator=(RenderQueue&&) noexcept = default;
+
+		template<typename Attrs, typename BS>
+		[[nodiscard]]
+		CommandRecorder<Attrs, BS> add(const Viewport& vp, const GraphicsPipeline<Attrs, BS>& ps, const DrawSortDesc& desc) noexcept {
+			close_item_();
+			items_.push_back(Item{ sort_key::make(ps.raw, desc), list_.mark_(), {} });
+			has_open_item_ = true;
+			return list_.record(vp, ps);
+		}
+
+		// Sorts the items, borrows the context and replays them. The queue can be submitted again until reset().
+		void submit() noexcept;
+
+		void reset() noexcept;
+
+		[[nodiscard]]
+		std::size_t item_count() const noexcept {
+			return items_.size();
+		}
+
+		[[nodiscard]]
+		bool is_empty() const noexcept {
+			return items_.empty();
+		}
+
+	private:
+		struct Item {
+			u64 key;
+			CommandList::Mark begin;
+			CommandList::Mark end;
+		};
+
+		struct SortEntry {
+			u64 key;
+			u32 item;
+		};
+
+		void close_item_() noexcept;
+		void sort_() noexcept;
+
+		CommandList list_;
+		std::vector<Item> items_;
+		std::vector<SortEntry> order_;
+		std::vector<SortEntry> scratch_;
+		bool has_open_item_ = false;
+		bool is_sorted_ = true;
+	};
+
+	namespace tests {
+		static_assert(sort_key::quantize_depth(0.5f) < sort_key::quantize_depth(1.f));
+		static_assert(sort_key::quantize_depth(1.f) < sort_key::quantize_depth(1000.f));
+		static_assert(sort_key::quantize_depth(-1.f) == 0);
+
+		constexpr detail::GraphicsPipelineRaw kSortKeyPipeline{ .state = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* program */ 3 } };
+		static_assert(sort_key::make(kSortKeyPipeline, { 0, 1.f, false }) < sort_key::make(kSortKeyPipeline, { 0, 2.f, false }));
+		static_assert(sort_key::make(kSortKeyPipeline, { 0, 2.f, true }) < sort_key::make(kSortKeyPipeline, { 0, 1.f, true }));
+		static_assert(sort_key::make(kSortKeyPipeline, { 7, 100.f, false }) < sort_key::make(kSortKeyPipeline, { 0, 0.f, true }));
+	}
+}
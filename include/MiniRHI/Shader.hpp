@@ -39,6 +39,10 @@ namespace minirhi {
 			eR_Paren,
 			eEqSign,
 			eSemicolon,
+			eL_Brace,
+			eR_Brace,
+			eL_Bracket,
+			eR_Bracket,
 			eNum,
 			eIdent,
 			eEof,
@@ -136,6 +140,10 @@ namespace minirhi {
 				case ')': ++current; return Token{ make_sv(begin, current), TokenType::eR_Paren };
 				case '=': ++current; return Token{ make_sv(begin, current), TokenType::eEqSign };
 				case ';': ++current; return Token{ make_sv(begin, current), TokenType::eSemicolon };
+				case '{': ++current; return Token{ make_sv(begin, current), TokenType::eL_Brace };
+				case '}': ++current; return Token{ make_sv(begin, current), TokenType::eR_Brace };
+				case '[': ++current; return Token{ make_sv(begin, current), TokenType::eL_Bracket };
+				case ']': ++current; return Token{ make_sv(begin, current), TokenType::eR_Bracket };
 				}
 				++current;
 				return Token::unknown();
@@ -182,8 +190,16 @@ namespace minirhi {
 			return count;
 		}
 
+		// Counts input layouts only, 'layout(std140)' of uniform blocks is skipped.
 		consteval std::size_t layout_count(std::string_view code) {
-			return name_count(code, "layout");
+			Lexer lexer{ code };
+			std::size_t count = 0;
+			for (Token token = lexer.next(); token != Token::end_of_file(); token = lexer.next()) {
+				if (token.type == TokenType::eKW_Layout && lexer.next().type == TokenType::eL_Paren && lexer.next().type == TokenType::eKW_Location) {
+					++count;
+				}
+			}
+			return count;
 		}
 
 		consteval std::size_t uniform_count(std::string_view code) {
@@ -211,7 +227,8 @@ namespace minirhi {
 						throw "Unexpected token. Expected '('.";
 					}
 					if (token = lexer.next(); token.type != TokenType::eKW_Location) {
-						throw "Unexpected token. Expected 'location'.";
+						// Not an input layout, e.g. 'layout(std140)'.
+						continue;
 					}
 					if (token = lexer.next(); token.type != TokenType::eEqSign) {
 						throw "Unexpected token. Expected '='.";
@@ -242,7 +259,11 @@ namespace minirhi {
 			return attr_types;
 		}
 
-		// grammar rule: 'uniform' ident ident ';'
+		/*
+		* grammar rule: 'uniform' ident ident ';'
+		*             | 'uniform' ident '{' ... '}' ident? ';'
+		* Uniform blocks are returned as a (body, block name) pair, the body includes the braces.
+		*/
 		template<std::size_t N>
  		consteval auto parse_uniforms(std::string_view code) {
 			const std::size_t off = code.find("uniform");
@@ -259,7 +280,17 @@ namespace minirhi {
 						throw "Unexpected token. Expected identifier.";
 					}
 					auto type_name = token.value;
-					if (token = lexer.next(); token.type != TokenType::eIdent) {
+					if (token = lexer.next(); token.type == TokenType::eL_Brace) {
+						const Lexer::It body_begin = std::prev(lexer.current);
+						while ((token = lexer.next()).type != TokenType::eR_Brace) {
+							if (token.type == TokenType::eEof) {
+								throw "Unexpected end of file. Expected '}'.";
+							}
+						}
+						uniforms[i++] = std::make_pair(Lexer::make_sv(body_begin, lexer.current), type_name);
+						continue;
+					}
+					if (token.type != TokenType::eIdent) {
 						throw "Unexpected token. Expected identifier.";
 					}
 					auto obj_name = token.value;
@@ -269,6 +300,66 @@ namespace minirhi {
 			return uniforms;
 		}
 
+		[[nodiscard]]
+		constexpr bool is_uniform_block(std::string_view type_name) noexcept {
+			return !type_name.empty() && type_name.front() == '{';
+		}
+
+		struct UniformBlockMember {
+			std::string_view type;
+			std::string_view name;
+			// 0 for non-array members
+			std::size_t array_size = 0;
+
+			constexpr bool operator==(const UniformBlockMember&) const noexcept = default;
+		};
+
+		consteval std::size_t uniform_block_member_count(std::string_view body) {
+			return name_count(body, ";");
+		}
+
+		// grammar rule: '{' (ident ident ('[' num ']')? ';')* '}'
+		template<std::size_t N>
+		consteval auto parse_uniform_block(std::string_view body) {
+			Lexer lexer{ body };
+			Token token{};
+			std::array<UniformBlockMember, N> members;
+			std::size_t i = 0;
+
+			if (token = lexer.next(); token.type != TokenType::eL_Brace) {
+				throw "Unexpected token. Expected '{'.";
+			}
+			while ((token = lexer.next()).type != TokenType::eR_Brace) {
+				if (token.type != TokenType::eIdent) {
+					throw "Unexpected token. Expected type identifier.";
+				}
+				members[i].type = token.value;
+
+				if (token = lexer.next(); token.type != TokenType::eIdent) {
+					throw "Unexpected token. Expected identifier.";
+				}
+				members[i].name = token.value;
+
+				if (token = lexer.next(); token.type == TokenType::eL_Bracket) {
+					if (token = lexer.next(); token.type != TokenType::eNum) {
+						throw "Unexpected token. Expected array size.";
+					}
+					for (char c : token.value) {
+						members[i].array_size = members[i].array_size * 10 + std::size_t(c - '0');
+					}
+					if (token = lexer.next(); token.type != TokenType::eR_Bracket) {
+						throw "Unexpected token. Expected ']'.";
+					}
+					token = lexer.next();
+				}
+				if (token.type != TokenType::eSemicolon) {
+					throw "Unexpected token. Expected ';'.";
+				}
+				++i;
+			}
+			return members;
+		}
+
 		namespace tests {
 			using namespace std::string_view_literals;
 
@@ -309,6 +400,35 @@ uniform vec3 light_pos;
 					std::make_pair("vec3"sv, "light_pos"sv),
 				})
 			);
+
+			inline static constexpr FixedString kBlockShader = R"str(
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (std140) uniform Camera {
+    mat4 view;
+    vec4 planes[6];
+};
+uniform float time;
+)str";
+
+			static_assert(layout_count(kBlockShader) == 1);
+			static_assert(parse_input_layout<layout_count(kBlockShader)>(kBlockShader) == std::to_array({ "vec3"sv }));
+
+			static_assert(
+				parse_uniforms<uniform_count(kBlockShader)>(kBlockShader) ==
+				std::to_array({ 
+					std::make_pair("{\n    mat4 view;\n    vec4 planes[6];\n}"sv, "Camera"sv),
+					std::make_pair("float"sv, "time"sv),
+				})
+			);
+
+			static_assert(
+				parse_uniform_block<2>("{ mat4 view; vec4 planes[6]; }") ==
+				std::to_array({ 
+					UniformBlockMember{ "mat4"sv, "view"sv, 0 },
+					UniformBlockMember{ "vec4"sv, "planes"sv, 6 },
+				})
+			);
 		}
 	}
 
@@ -335,6 +455,7 @@ uniform vec3 light_pos;
 		VtxShaderHandle compile_vtx_shader_impl_(std::string_view code) noexcept;
 		FragShaderHandle compile_frag_shader_impl_(std::string_view code) noexcept;
 		void destroy_shader_impl_(u32 shader) noexcept;
+		void destroy_program_impl_(u32 program) noexcept;
 	}
 
 	class ShaderCompiler {
@@ -351,6 +472,15 @@ uniform vec3 light_pos;
 
 		static u32 link_shaders_span(std::span<u32> shaders) noexcept;
 
+		// Resolves the location of every uniform in names. Missing uniforms get -1, which GL ignores on upload.
+		static void get_uniform_locations(u32 program, std::span<const std::string_view> names, std::span<i32> locations) noexcept;
+
+		/*
+		* Assigns binding points to the uniform blocks among names, in order starting from 0, 
+		* and stores them in locations. Blocks missing from the program get -1.
+		*/
+		static void get_uniform_block_bindings(u32 program, std::span<const std::string_view> names, std::span<const bool> is_block, std::span<i32> locations) noexcept;
+
 		template<typename... Shaders>
 		static u32 link_shaders(Shaders... shaders) noexcept {
 			auto shaders_arr = std::to_array({
@@ -368,6 +498,11 @@ uniform vec3 light_pos;
 		static void destroy_shader(ShaderHandle<Type> shader) noexcept {
 			detail::destroy_shader_impl_(shader.handle);
 		}
+
+		// Deletes a program returned by link_shaders, along with the uniform values cached for it.
+		static void destroy_program(u32 program) noexcept {
+			detail::destroy_program_impl_(program);
+		}
 	};
 
 }
@@ -0,0 +1,72 @@
+#pragma once
+#include <Core/Core.hpp>
+
+/*
+ *  FRAME STATISTICS
+ *
+ *  Counters incremented where MiniRHI calls into GL, enabled by defining MINIRHI_ENABLE_STATS
+ *  (cmake -DMINIRHI_ENABLE_STATS=ON). When disabled MINIRHI_STAT compiles to nothing and
+ *  the stats stay zero. Counters are not atomic, GL calls only happen on the context's thread.
+ *
+ *  Example:
+ *      minirhi::stats::next_frame();
+ *      const minirhi::FrameStats& last = minirhi::stats::get_last_frame();
+ *      if (last.draw_calls > kDrawCallBudget) { ... }
+ */
+
+namespace minirhi {
+	struct FrameStats {
+		u64 draw_calls = 0;
+		// Vertices of non-indexed draws, times the instance count
+		u64 vertices = 0;
+		// Indices of indexed draws, times the instance count. Indirect draws are not included.
+		u64 indices = 0;
+		u64 program_switches = 0;
+		u64 vao_binds = 0;
+		u64 texture_binds = 0;
+		u64 uniform_uploads = 0;
+		u64 buffer_bytes_uploaded = 0;
+		u64 texture_bytes_uploaded = 0;
+		// State changes that were requested but dropped by the state shadow
+		u64 redundant_state_calls = 0;
+	};
+
+	namespace stats {
+		namespace detail {
+			inline FrameStats gCurrentFrame{};
+			inline FrameStats gLastFrame{};
+		}
+
+		// Counters of the frame in progress.
+		[[nodiscard]]
+		inline const FrameStats& get_current_frame() noexcept {
+			return detail::gCurrentFrame;
+		}
+
+		// Counters of the frame before the last next_frame() call.
+		[[nodiscard]]
+		inline const FrameStats& get_last_frame() noexcept {
+			return detail::gLastFrame;
+		}
+
+		inline void next_frame() noexcept {
+			detail::gLastFrame = detail::gCurrentFrame;
+			detail::gCurrentFrame = FrameStats{};
+		}
+
+		[[nodiscard]]
+		constexpr bool is_enabled() noexcept {
+#ifdef MINIRHI_ENABLE_STATS
+			return true;
+#else
+			return false;
+#endif
+		}
+	}
+}
+
+#ifdef MINIRHI_ENABLE_STATS
+#define MINIRHI_STAT(Counter, Value) (::minirhi::stats::detail::gCurrentFrame.Counter += u64(Value))
+#else
+#define MINIRHI_STAT(Counter, Value) ((void)0)
+#endif
@@ -0,0 +1,248 @@
+#pragma once
+#include <array>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "MiniRHI/Shader.hpp"
+#include "MiniRHI/TypeInference.hpp"
+
+#include <Core/Core.hpp>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+/*
+ *  STD140 UNIFORM BLOCK LAYOUT CHECK
+ *
+ *  Compares members of a `layout(std140) uniform Name { ... };` block with the fields of
+ *  a C++ struct. Fields are deduced the same way as vertex attributes, std140 padding has to
+ *  be spelled out with `minirhi::Std140Pad<N>` fields, which are skipped.
+ *
+ *  Supports up to 8 fields in a struct. Arrays are supported for 16 byte types only
+ *  (vec4, uvec4, ivec4, mat4), since other types have a different array stride in C++.
+ *
+ *  Example:
+ *      layout(std140) uniform Light { vec3 position; float radius; vec3 color; };
+ *
+ *      struct Light {
+ *          glm::vec3 position;
+ *          f32 radius;
+ *          glm::vec3 color;
+ *          minirhi::Std140Pad<4> pad;
+ *      };
+ */
+
+namespace minirhi
+{
+	template<std::size_t N>
+	struct Std140Pad {
+		std::array<u8, N> bytes{};
+	};
+
+	namespace glsl {
+		struct Std140Member {
+			std::string_view type;
+			std::size_t array_size = 0;
+			std::size_t offset = 0;
+		};
+
+		struct Std140TypeInfo {
+			std::size_t alignment = 0;
+			std::size_t size = 0;
+		};
+
+		consteval Std140TypeInfo get_std140_type_info(std::string_view type) {
+			if (type == "float" || type == "int" || type == "uint" || type == "bool") {
+				return { 4, 4 };
+			}
+			if (type == "vec2" || type == "ivec2" || type == "uvec2") {
+				return { 8, 8 };
+			}
+			if (type == "vec3" || type == "ivec3" || type == "uvec3") {
+				return { 16, 12 };
+			}
+			if (type == "vec4" || type == "ivec4" || type == "uvec4") {
+				return { 16, 16 };
+			}
+			// Matrix columns are laid out like an array of vec4
+			if (type == "mat2") {
+				return { 16, 32 };
+			}
+			if (type == "mat3") {
+				return { 16, 48 };
+			}
+			if (type == "mat4") {
+				return { 16, 64 };
+			}
+			throw "Unsupported uniform block member type.";
+		}
+
+		[[nodiscard]]
+		constexpr std::size_t align_std140_(std::size_t offset, std::size_t alignment) noexcept {
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		template<std::size_t N>
+		consteval auto get_std140_layout(const std::array<UniformBlockMember, N>& members) {
+			std::array<Std140Member, N> layout;
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < N; i++) {
+				auto [alignment, size] = get_std140_type_info(members[i].type);
+				if (members[i].array_size != 0) {
+					// Array elements are aligned and padded to vec4
+					alignment = align_std140_(alignment, 16);
+					size = align_std140_(size, 16) * members[i].array_size;
+				}
+				offset = align_std140_(offset, alignment);
+				layout[i] = Std140Member{ members[i].type, members[i].array_size, offset };
+				offset += size;
+			}
+			return std::make_pair(layout, offset);
+		}
+	}
+
+	namespace detail_std140
+	{
+		template<typename T>
+		struct GlslType {
+			static constexpr std::string_view kName = "";
+			static constexpr std::size_t kArraySize = 0;
+			static constexpr bool kIsPadding = false;
+		};
+
+#define _MINIRHI_DECLARE_STD140_TYPE(Type, Name) \
+	template<> \
+	struct GlslType<Type> { \
+		static constexpr std::string_view kName = Name; \
+		static constexpr std::size_t kArraySize = 0; \
+		static constexpr bool kIsPadding = false; \
+	};
+
+		_MINIRHI_DECLARE_STD140_TYPE(f32, "float");
+		_MINIRHI_DECLARE_STD140_TYPE(u32, "uint");
+		_MINIRHI_DECLARE_STD140_TYPE(i32, "int");
+
+		_MINIRHI_DECLARE_STD140_TYPE(glm::vec2, "vec2");
+		_MINIRHI_DECLARE_STD140_TYPE(glm::uvec2, "uvec2");
+		_MINIRHI_DECLARE_STD140_TYPE(glm::ivec2, "ivec2");
+
+		_MINIRHI_DECLARE_STD140_TYPE(glm::vec3, "vec3");
+		_MINIRHI_DECLARE_STD140_TYPE(glm::uvec3, "uvec3");
+		_MINIRHI_DECLARE_STD140_TYPE(glm::ivec3, "ivec3");
+
+		_MINIRHI_DECLARE_STD140_TYPE(glm::vec4, "vec4");
+		_MINIRHI_DECLARE_STD140_TYPE(glm::uvec4, "uvec4");
+		_MINIRHI_DECLARE_STD140_TYPE(glm::ivec4, "ivec4");
+
+		_MINIRHI_DECLARE_STD140_TYPE(glm::mat4, "mat4");
+
+		template<std::size_t N>
+		struct GlslType<std::array<f32, N>> {
+			static constexpr std::string_view kName = N == 2 ? "vec2" : N == 3 ? "vec3" : N == 4 ? "vec4" : "";
+			static constexpr std::size_t kArraySize = 0;
+			static constexpr bool kIsPadding = false;
+		};
+
+		template<std::size_t N>
+		struct GlslType<Std140Pad<N>> {
+			static constexpr std::string_view kName = "";
+			static constexpr std::size_t kArraySize = 0;
+			static constexpr bool kIsPadding = true;
+		};
+
+		template<typename E, std::size_t N>
+			requires (!std::same_as<E, f32>)
+		struct GlslType<std::array<E, N>> {
+			static constexpr bool kIsVec4Sized = sizeof(E) % 16 == 0 && GlslType<E>::kArraySize == 0 && !GlslType<E>::kName.empty();
+			static constexpr std::string_view kName = kIsVec4Sized ? GlslType<E>::kName : "";
+			static constexpr std::size_t kArraySize = N;
+			static constexpr bool kIsPadding = false;
+		};
+
+		struct CppMember {
+			std::string_view type;
+			std::size_t array_size = 0;
+			std::size_t offset = 0;
+		};
+
+		template<typename... Ts>
+		struct Fields {
+			static constexpr std::size_t kCount = ((GlslType<Ts>::kIsPadding ? 0 : 1) + ... + 0);
+
+			// Offsets follow the natural C++ layout, which is what a standard layout aggregate gets.
+			static consteval auto get_members() {
+				std::array<CppMember, kCount> members;
+				std::size_t offset = 0;
+				std::size_t i = 0;
+				([&] {
+					offset = glsl::align_std140_(offset, alignof(Ts));
+					if (!GlslType<Ts>::kIsPadding) {
+						if (GlslType<Ts>::kName.empty()) {
+							throw "Unsupported uniform block field type.";
+						}
+						members[i++] = CppMember{ GlslType<Ts>::kName, GlslType<Ts>::kArraySize, offset };
+					}
+					offset += sizeof(Ts);
+				}(), ...);
+				return members;
+			}
+		};
+
+		template<typename T>
+		using DeduceFields = detail_ti::Decompose<Fields, T>;
+	}
+
+	/*
+	* Evaluates to true or fails to compile, pointing at the first mismatch.
+	* Body is a uniform block body as returned by glsl::parse_uniforms.
+	*/
+	template<typename T, FixedString Body>
+	consteval bool check_std140_layout() {
+		static_assert(std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>, "Uniform block data must be a trivially copyable standard layout struct!");
+
+		constexpr auto kBlockMembers = glsl::parse_uniform_block<glsl::uniform_block_member_count(Body)>(Body);
+		constexpr auto kLayout = glsl::get_std140_layout(kBlockMembers);
+		constexpr auto kFields = detail_std140::DeduceFields<T>::get_members();
+
+		if (kFields.size() != kBlockMembers.size()) {
+			throw "Uniform block member count does not match the C++ struct!";
+		}
+		for (std::size_t i = 0; i < kFields.size(); i++) {
+			if (kFields[i].type != kLayout.first[i].type || kFields[i].array_size != kLayout.first[i].array_size) {
+				throw "Uniform block member type does not match the C++ struct field!";
+			}
+			if (kFields[i].offset != kLayout.first[i].offset) {
+				throw "C++ struct field offset does not follow std140, add minirhi::Std140Pad<N> fields!";
+			}
+		}
+		if (sizeof(T) < kLayout.second) {
+			throw "C++ struct is smaller than the std140 uniform block!";
+		}
+		return true;
+	}
+
+	namespace tests {
+		struct Std140Camera {
+			glm::mat4 view;
+			glm::mat4 projection;
+			glm::vec3 position;
+			f32 time;
+			std::array<glm::vec4, 6> planes;
+		};
+		static_assert(check_std140_layout<Std140Camera, "{ mat4 view; mat4 projection; vec3 position; float time; vec4 planes[6]; }">());
+
+		struct Std140Light {
+			f32 radius;
+			Std140Pad<12> pad;
+			std::array<f32, 3> color;
+		};
+		static_assert(check_std140_layout<Std140Light, "{ float radius; vec3 color; }">());
+
+		static_assert(
+			glsl::get_std140_layout(glsl::parse_uniform_block<3>("{ float a; vec3 b; vec2 c; }")).second == 40
+		);
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <array>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "MiniRHI/Buffer.hpp"
+#include "MiniRHI/Fence.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	struct StreamBufferDesc {
+		// Kind of elements pushed, push_vertices()/push_indices() assert that it matches.
+		BufferType type = BufferType::eVertex;
+		// Bytes that can be allocated during a single frame.
+		std::size_t frame_size = 0;
+		u32 frame_count = 3;
+	};
+
+	struct StreamAllocation {
+		u8* data = nullptr;
+		u32 handle = kBufferInvalidHandle;
+		std::size_t offset = 0;
+		std::size_t size = 0;
+
+		[[nodiscard]]
+		bool is_valid() const noexcept {
+			return data != nullptr;
+		}
+	};
+
+	/*
+	* Ring buffer for per-frame dynamic data, split into frame_count regions.
+	* With buffer storage support the whole buffer is mapped once (persistent + coherent) and 
+	* a region is reused only after the fence inserted at the end of its frame is signaled.
+	* Otherwise writes go to a CPU staging copy which is uploaded with glBufferSubData on flush(),
+	* and the buffer is orphaned whenever the ring wraps around.
+	*/
+	class StreamBuffer {
+	public:
+		static constexpr u32 kMaxFrames = 4;
+
+		explicit StreamBuffer() noexcept = default;
+		explicit StreamBuffer(const StreamBufferDesc& desc) noexcept;
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		StreamBuffer(StreamBuffer&& rhs) noexcept;
+		StreamBuffer& operator=(StreamBuffer&& rhs) noexcept;
+
+		~StreamBuffer() noexcept;
+
+		/*
+		* Bump allocates size bytes in the current frame region, offset is aligned to alignment (which doesn't have to be a power of two).
+		* Returns an invalid allocation when the region is exhausted.
+		*/
+		[[nodiscard]]
+		StreamAllocation allocate(std::size_t size, std::size_t alignment = 1) noexcept;
+
+		template<TVtxElem Elem>
+		[[nodiscard]]
+		VertexBufferView<Elem> push_vertices(std::span<const Elem> vertices) noexcept {
+			return push_<BufferType::eVertex>(vertices);
+		}
+
+		template<TIndexElem Idx>
+		[[nodiscard]]
+		IndexBufferView<Idx> push_indices(std::span<const Idx> indices) noexcept {
+			return push_<BufferType::eIndex>(indices);
+		}
+
+		// Makes everything written since the last flush visible to the GPU. Call before drawing from the new data.
+		void flush() noexcept;
+
+		// Fences the current region and moves on to the next one, waiting for the GPU if it still reads from it.
+		void next_frame() noexcept;
+
+		[[nodiscard]]
+		u32 handle() const noexcept {
+			return handle_;
+		}
+
+		[[nodiscard]]
+		bool is_persistent() const noexcept {
+			return mapped_ != nullptr;
+		}
+
+	private:
+		template<BufferType Type, typename Elem>
+		BufferView<Type, Elem> push_(std::span<const Elem> elements) noexcept {
+			assert(Type == type_ && "Elements don't match the StreamBuffer type!");
+			const StreamAllocation alloc = allocate(elements.size_bytes(), sizeof(Elem));
+			if (!alloc.is_valid()) {
+				return BufferView<Type, Elem>{};
+			}
+			std::memcpy(alloc.data, elements.data(), elements.size_bytes());
+			return BufferView<Type, Elem>{ alloc.handle, alloc.offset, elements.size() };
+		}
+
+		void release_() noexcept;
+
+		u32 handle_ = kBufferInvalidHandle;
+		BufferType type_ = BufferType::eVertex;
+		u8* mapped_ = nullptr;
+		std::vector<u8> staging_;
+		std::size_t frame_size_ = 0;
+		u32 frame_count_ = 0;
+		u32 frame_ = 0;
+		std::size_t head_ = 0;
+		std::size_t flushed_ = 0;
+		std::array<Fence, kMaxFrames> fences_{};
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <iosfwd>
+#include <string_view>
+
+#include <Core/Core.hpp>
+
+/*
+ *  TRACING
+ *
+ *  Records CPU scopes and GPU profiler frames into one timeline and writes it as Chrome trace-event
+ *  JSON, which opens in chrome://tracing and ui.perfetto.dev. CPU scopes get a track per thread,
+ *  GPU scopes a separate track aligned to the CPU clock at begin_capture().
+ *  MiniRHI's own scopes (draw context setup, shader compilation, texture creation) are compiled in
+ *  by defining MINIRHI_ENABLE_TRACING (cmake -DMINIRHI_ENABLE_TRACING=ON), MINIRHI_TRACE_SCOPE
+ *  compiles to nothing otherwise. Outside of a capture a scope costs one relaxed load.
+ *  Event names are not copied, use string literals.
+ *
+ *  Example:
+ *      minirhi::trace::begin_capture();
+ *      for (...) {
+ *          MINIRHI_TRACE_SCOPE("frame");
+ *          ...
+ *          profiler.next_frame();
+ *          minirhi::trace::add_gpu_frame(profiler);
+ *      }
+ *      minirhi::trace::end_capture();
+ *      minirhi::trace::write_chrome_trace("frame.json");
+ */
+
+namespace minirhi {
+	class GpuProfiler;
+
+	namespace trace {
+		// Events recorded per capture before the rest are dropped, the event buffer grows on demand up to it.
+		inline static constexpr std::size_t kDefaultMaxEvents = 1 << 20;
+
+		namespace detail {
+			inline std::atomic<bool> gCapturing{ false };
+		}
+
+		// Starts a capture, events of the previous one are dropped. Has to be called on the context's thread.
+		void begin_capture(std::size_t max_events = kDefaultMaxEvents) noexcept;
+		void end_capture() noexcept;
+
+		[[nodiscard]]
+		inline bool is_capturing() noexcept {
+			return detail::gCapturing.load(std::memory_order_relaxed);
+		}
+
+		// Nanoseconds since begin_capture().
+		[[nodiscard]]
+		u64 now() noexcept;
+
+		// Records an event on the calling thread's track. Ignored outside of a capture.
+		void add_cpu_event(std::string_view name, u64 begin, u64 end) noexcept;
+
+		// Copies the latest resolved frame of profiler onto the GPU track. Call after profiler.next_frame().
+		void add_gpu_frame(const GpuProfiler& profiler) noexcept;
+
+		// Events that didn't fit into max_events.
+		[[nodiscard]]
+		u64 get_dropped_event_count() noexcept;
+
+		bool write_chrome_trace(std::ostream& out) noexcept;
+		bool write_chrome_trace(const char* path) noexcept;
+
+		// Records the time spent in its lifetime as a CPU event.
+		class [[nodiscard]] Scope {
+		public:
+			explicit Scope(std::string_view name) noexcept
+				: name_(name)
+				, begin_(is_capturing() ? now() : kNotCapturing)
+			{}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+			~Scope() noexcept {
+				if (begin_ != kNotCapturing) {
+					add_cpu_event(name_, begin_, now());
+				}
+			}
+
+		private:
+			static constexpr u64 kNotCapturing = ~u64(0);
+
+			std::string_view name_;
+			u64 begin_;
+		};
+	}
+}
+
+#define MINIRHI_TRACE_CONCAT_IMPL_(A, B) A##B
+#define MINIRHI_TRACE_CONCAT_(A, B) MINIRHI_TRACE_CONCAT_IMPL_(A, B)
+
+#ifdef MINIRHI_ENABLE_TRACING
+#define MINIRHI_TRACE_SCOPE(Name) const ::minirhi::trace::Scope MINIRHI_TRACE_CONCAT_(minirhi_trace_scope_, __LINE__){ Name }
+#else
+#define MINIRHI_TRACE_SCOPE(Name) ((void)0)
+#endif
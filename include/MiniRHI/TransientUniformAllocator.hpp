@@ -0,0 +1,47 @@
+#pragma once
+#include <limits>
+
+#include "MiniRHI/PipelineState.hpp"
+#include "MiniRHI/StreamBuffer.hpp"
+
+#include <Core/Core.hpp>
+
+namespace minirhi {
+	/*
+	* Frame-scoped linear allocator for small constant blocks, e.g. per-draw object data.
+	* Blocks are copied into a StreamBuffer ring and bound by offset with glBindBufferRange.
+	* Allocations stay valid until the next call to next_frame().
+	*/
+	class TransientUniformAllocator {
+	public:
+		explicit TransientUniformAllocator() noexcept = default;
+		explicit TransientUniformAllocator(std::size_t frame_size, u32 frame_count = 3) noexcept;
+
+		// Returns an invalid range when the frame's part of the ring is exhausted, nothing may be bound then.
+		[[nodiscard]]
+		UniformBufferRange allocate(const void* data, std::size_t size) noexcept;
+
+		template<typename T>
+		[[nodiscard]]
+		UniformBufferRange push(const T& value) noexcept {
+			static_assert(std::is_trivially_copyable_v<T>, "Transient uniform data must be trivially copyable!");
+			return allocate(&value, sizeof(T));
+		}
+
+		void next_frame() noexcept {
+			ring_.next_frame();
+			frame_++;
+		}
+
+		[[nodiscard]]
+		u64 frame() const noexcept {
+			return frame_;
+		}
+
+	private:
+		StreamBuffer ring_;
+		// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+		std::size_t alignment_ = 256;
+		u64 frame_ = 0;
+	};
+}
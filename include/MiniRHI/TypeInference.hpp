@@ -14,7 +14,7 @@
  *  will use that. Otherwise, it will deduce what fields are in your Vertex struct
  *  and return you the `minirhi::minirhi::VtxAttrArr<...>`.
  *
- *  Supports up to 7 elements in a struct.
+ *  Supports up to 8 elements in a struct.
  *  
  *  Example:
  *      struct Vertex
@@ -96,49 +96,66 @@ namespace minirhi
             using Ty = minirhi::VtxAttrArr<minirhi::VtxAttr<typename Deduce<T>::Fmt>...>;
         };
 
-        template<class T>
-        consteval auto convert() noexcept /* -> ToVtxArr<type0, type1, ...> */
+        /*
+         *  Instantiates List<field types...> for the fields of an aggregate, up to 8 of them.
+         *  Shared by vertex attribute deduction and the std140 layout check.
+         */
+        template<template<typename...> class List, class T>
+        consteval auto decompose() noexcept /* -> List<type0, type1, ...> */
         {
             using type = std::decay_t<T>;
             T object = *std::bit_cast<T*>(nullptr); // safe: code never runs
 
-            if constexpr (IsBracesConstructibleN<type, 6>())
+            if constexpr (IsBracesConstructibleN<type, 8>())
+            {
+                auto&& [p1, p2, p3, p4, p5, p6, p7, p8] = object;
+                return List<decltype(p1), decltype(p2), decltype(p3), decltype(p4), decltype(p5), decltype(p6), decltype(p7), decltype(p8)>{};
+            }
+            else if constexpr (IsBracesConstructibleN<type, 7>())
+            {
+                auto&& [p1, p2, p3, p4, p5, p6, p7] = object;
+                return List<decltype(p1), decltype(p2), decltype(p3), decltype(p4), decltype(p5), decltype(p6), decltype(p7)>{};
+            }
+            else if constexpr (IsBracesConstructibleN<type, 6>())
             {
                 auto&& [p1, p2, p3, p4, p5, p6] = object;
-                return ToVtxArr<decltype(p1), decltype(p2), decltype(p3), decltype(p4), decltype(p5), decltype(p6)>{};
+                return List<decltype(p1), decltype(p2), decltype(p3), decltype(p4), decltype(p5), decltype(p6)>{};
             }
-        	else if constexpr (IsBracesConstructibleN<type, 5>())
+            else if constexpr (IsBracesConstructibleN<type, 5>())
             {
                 auto&& [p1, p2, p3, p4, p5] = object;
-                return ToVtxArr<decltype(p1), decltype(p2), decltype(p3), decltype(p4), decltype(p5)>{};
+                return List<decltype(p1), decltype(p2), decltype(p3), decltype(p4), decltype(p5)>{};
             }
             else if constexpr (IsBracesConstructibleN<type, 4>())
             {
                 auto&& [p1, p2, p3, p4] = object;
-                return ToVtxArr<decltype(p1), decltype(p2), decltype(p3), decltype(p4)>{};
+                return List<decltype(p1), decltype(p2), decltype(p3), decltype(p4)>{};
             }
             else if constexpr (IsBracesConstructibleN<type, 3>())
             {
                 auto&& [p1, p2, p3] = object;
-                return ToVtxArr<decltype(p1), decltype(p2), decltype(p3)>{};
+                return List<decltype(p1), decltype(p2), decltype(p3)>{};
             }
             else if constexpr (IsBracesConstructibleN<type, 2>())
             {
                 auto&& [p1, p2] = object;
-                return ToVtxArr<decltype(p1), decltype(p2)>{};
+                return List<decltype(p1), decltype(p2)>{};
             }
             else if constexpr (IsBracesConstructibleN<type, 1>())
             {
                 auto&& [p1] = object;
-                return ToVtxArr<decltype(p1)>{};
+                return List<decltype(p1)>{};
             }
             else {
-                return ToVtxArr<> {};
+                return List<> {};
             }
         }
 
+        template<template<typename...> class List, typename T>
+        using Decompose = decltype(decompose<List, T>());
+
         template<typename T>
-        using Convert = typename decltype(convert<T>())::Ty;
+        using Convert = typename Decompose<ToVtxArr, T>::Ty;
 
         template<typename T>
         struct IsVtxAttrArrEmpty;
@@ -173,6 +190,13 @@ namespace minirhi
     template<typename T>
     using MakeVertexAttributes = decltype(MakeVertexAttributes_t<T>());
 
+    /*
+     *  Same as MakeVertexAttributes, but the attributes are per-instance.
+     *  Attributes that already declare a step rate in `T::get_attrs()` keep it.
+     */
+    template<typename T, u32 StepRate = 1>
+    using MakeInstanceAttributes = typename WithStepRate<MakeVertexAttributes<T>, StepRate>::Type;
+
     namespace test_type_deduction
     {
 	    struct Vertex1
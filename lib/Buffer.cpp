@@ -1,4 +1,6 @@
 #include "MiniRHI/Buffer.hpp"
+#include "MiniRHI/Stats.hpp"
+#include "MiniRHI/DeletionQueue.hpp"
 #ifndef ANDROID
 #include <glew/glew.h>
 #else
@@ -12,26 +14,44 @@ namespace minirhi {
         case BufferType::eVertex: return GL_ARRAY_BUFFER;
         case BufferType::eIndex: return GL_ELEMENT_ARRAY_BUFFER;
         case BufferType::eConstant: return GL_UNIFORM_BUFFER;
+        case BufferType::eIndirect: return GL_DRAW_INDIRECT_BUFFER;
         default: return 0;
         }
     }
 
     namespace detail {
-        u32 create_buffer_(BufferType type, std::size_t size_in_bytes, const void* data) noexcept {
+        void evict_buffer_bindings_(u32 buffer) noexcept;
+
+        u32 create_buffer_([[maybe_unused]] BufferType type, std::size_t size_in_bytes, const void* data) noexcept {
             u32 handle = 0;
             glGenBuffers(1, &handle);
 
+            // Uploads go through the copy target, so that creating an index buffer
+            // can't rebind the element buffer of whatever cached VAO is currently bound.
             if (data != nullptr && size_in_bytes != 0) {
-                GLenum target = get_buffer_type(type);
-                glBindBuffer(target, handle);
-                glBufferData(target, static_cast<GLsizeiptr>(size_in_bytes), data, GL_STATIC_DRAW);
-                glBindBuffer(target, 0);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+                glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size_in_bytes), data, GL_STATIC_DRAW);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                MINIRHI_STAT(buffer_bytes_uploaded, size_in_bytes);
             }
             return handle;
         }
 
+        void update_buffer_(u32 handle, std::size_t offset, std::size_t size_in_bytes, const void* data) noexcept {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size_in_bytes), data);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            MINIRHI_STAT(buffer_bytes_uploaded, size_in_bytes);
+        }
+
         void destroy_buffer_(u32 &handle) noexcept {
-            glDeleteBuffers(1, &handle);
+            if (handle == kBufferInvalidHandle) {
+                return;
+            }
+            if (!defer_deletion_(DeletionKind::eBuffer, handle)) {
+                evict_buffer_bindings_(handle);
+                glDeleteBuffers(1, &handle);
+            }
             handle = kBufferInvalidHandle;
         }
     }
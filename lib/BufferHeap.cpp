@@ -0,0 +1,259 @@
+#include "MiniRHI/BufferHeap.hpp"
+#include "MiniRHI/Stats.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace minirhi {
+	[[nodiscard]]
+	static std::size_t align_up(std::size_t value, std::size_t alignment) noexcept {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	[[nodiscard]]
+	static u32 create_page_buffer(std::size_t size) noexcept {
+		u32 handle = 0;
+		glGenBuffers(1, &handle);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+		glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return handle;
+	}
+
+	BufferHeapBase::BufferHeapBase(BufferType type, std::size_t page_size) noexcept
+		: type_(type)
+		, page_size_(page_size)
+	{
+		assert(page_size > 0);
+		if (type == BufferType::eConstant) {
+			GLint alignment = 1;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			min_alignment_ = static_cast<std::size_t>(std::max(alignment, 1));
+		}
+	}
+
+	BufferHeapBase& BufferHeapBase::operator=(BufferHeapBase&& rhs) noexcept {
+		if (this == &rhs) {
+			return *this;
+		}
+
+		release_();
+		type_ = rhs.type_;
+		page_size_ = rhs.page_size_;
+		min_alignment_ = rhs.min_alignment_;
+		pages_ = std::move(rhs.pages_);
+		blocks_ = std::move(rhs.blocks_);
+		free_ids_ = std::move(rhs.free_ids_);
+		rhs.pages_.clear();
+
+		return *this;
+	}
+
+	BufferHeapBase::~BufferHeapBase() noexcept {
+		release_();
+	}
+
+	void BufferHeapBase::release_() noexcept {
+		for (auto& page : pages_) {
+			detail::destroy_buffer_(page.handle);
+		}
+		pages_.clear();
+		blocks_.clear();
+		free_ids_.clear();
+	}
+
+	std::size_t BufferHeapBase::used_bytes() const noexcept {
+		std::size_t used = 0;
+		for (const auto& block : blocks_) {
+			used += block.live ? block.size : 0;
+		}
+		return used;
+	}
+
+	u32 BufferHeapBase::add_page_(std::size_t size) noexcept {
+		Page page{};
+		page.handle = create_page_buffer(size);
+		page.size = size;
+		page.free_ranges.push_back(Range{ 0, size });
+		pages_.push_back(std::move(page));
+		return static_cast<u32>(pages_.size() - 1);
+	}
+
+	bool BufferHeapBase::allocate_in_page_(u32 page_index, std::size_t size, std::size_t alignment, Block& block) noexcept {
+		auto& ranges = pages_[page_index].free_ranges;
+		for (std::size_t i = 0; i < ranges.size(); i++) {
+			const Range range = ranges[i];
+			const std::size_t offset = align_up(range.offset, alignment);
+			if (offset + size > range.offset + range.size) {
+				continue;
+			}
+
+			// Keep the alignment padding in front and the tail behind as free ranges.
+			const Range head{ range.offset, offset - range.offset };
+			const Range tail{ offset + size, range.offset + range.size - offset - size };
+			ranges.erase(ranges.begin() + static_cast<std::ptrdiff_t>(i));
+			if (tail.size != 0) {
+				ranges.insert(ranges.begin() + static_cast<std::ptrdiff_t>(i), tail);
+			}
+			if (head.size != 0) {
+				ranges.insert(ranges.begin() + static_cast<std::ptrdiff_t>(i), head);
+			}
+
+			block.page = page_index;
+			block.offset = offset;
+			return true;
+		}
+		return false;
+	}
+
+	u32 BufferHeapBase::allocate_(std::size_t size, std::size_t alignment, const void* data) noexcept {
+		assert(size > 0);
+
+		Block block{};
+		block.size = size;
+		block.alignment = std::lcm(alignment, min_alignment_);
+		block.live = true;
+
+		bool found = false;
+		for (u32 page = 0; page < pages_.size() && !found; page++) {
+			found = allocate_in_page_(page, size, block.alignment, block);
+		}
+		if (!found) {
+			// Allocations bigger than a page get a page of their own.
+			const u32 page = add_page_(std::max(page_size_, size));
+			found = allocate_in_page_(page, size, block.alignment, block);
+			assert(found);
+		}
+
+		u32 id = 0;
+		if (!free_ids_.empty()) {
+			id = free_ids_.back();
+			free_ids_.pop_back();
+			block.generation = blocks_[id].generation;
+			blocks_[id] = block;
+		} else {
+			id = static_cast<u32>(blocks_.size());
+			blocks_.push_back(block);
+		}
+
+		if (data != nullptr) {
+			update_(id, block.generation, 0, size, data);
+		}
+		return id;
+	}
+
+	void BufferHeapBase::update_(u32 id, u32 generation, std::size_t offset, std::size_t size, const void* data) noexcept {
+		const Block& block = block_(id, generation);
+		assert(offset + size <= block.size);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, pages_[block.page].handle);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(block.offset + offset), static_cast<GLsizeiptr>(size), data);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		MINIRHI_STAT(buffer_bytes_uploaded, size);
+	}
+
+	void BufferHeapBase::free_(u32 id, u32 generation) noexcept {
+		assert(is_live_(id, generation) && "Stale or invalid BufferHeap handle!");
+		Block& block = blocks_[id];
+
+		auto& ranges = pages_[block.page].free_ranges;
+		auto it = std::lower_bound(ranges.begin(), ranges.end(), block.offset, [](const Range& range, std::size_t offset) {
+			return range.offset < offset;
+		});
+		it = ranges.insert(it, Range{ block.offset, block.size });
+
+		// Coalesce with the following and the preceding free range.
+		if (auto next = it + 1; next != ranges.end() && it->offset + it->size == next->offset) {
+			it->size += next->size;
+			it = ranges.erase(next) - 1;
+		}
+		if (it != ranges.begin()) {
+			if (auto prev = it - 1; prev->offset + prev->size == it->offset) {
+				prev->size += it->size;
+				ranges.erase(it);
+			}
+		}
+
+		block.live = false;
+		block.generation++;
+		free_ids_.push_back(id);
+	}
+
+	void BufferHeapBase::copy_block_(u32 src, u32 dst, std::size_t src_offset, std::size_t dst_offset, std::size_t size, u32& bound_src, u32& bound_dst) noexcept {
+		if (bound_src != src) {
+			glBindBuffer(GL_COPY_READ_BUFFER, src);
+			bound_src = src;
+		}
+		if (bound_dst != dst) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, dst);
+			bound_dst = dst;
+		}
+		glCopyBufferSubData(
+			GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 
+			static_cast<GLintptr>(src_offset), static_cast<GLintptr>(dst_offset), 
+			static_cast<GLsizeiptr>(size)
+		);
+	}
+
+	void BufferHeapBase::defragment() noexcept {
+		std::vector<u32> live_blocks;
+		for (u32 id = 0; id < blocks_.size(); id++) {
+			if (blocks_[id].live) {
+				live_blocks.push_back(id);
+			}
+		}
+
+		// Packing in the current order keeps blocks that were allocated together next to each other.
+		std::sort(live_blocks.begin(), live_blocks.end(), [this](u32 lhs, u32 rhs) {
+			const Block& a = blocks_[lhs];
+			const Block& b = blocks_[rhs];
+			return a.page != b.page ? a.page < b.page : a.offset < b.offset;
+		});
+
+		// Blocks are copied into new buffers, glCopyBufferSubData can't move overlapping ranges within one.
+		std::vector<Page> new_pages;
+		std::size_t cursor = 0;
+		u32 bound_src = kBufferInvalidHandle;
+		u32 bound_dst = kBufferInvalidHandle;
+
+		for (u32 id : live_blocks) {
+			Block& block = blocks_[id];
+			std::size_t offset = align_up(cursor, block.alignment);
+			if (new_pages.empty() || offset + block.size > new_pages.back().size) {
+				// Allocations bigger than a page get a page of their own, like in allocate_().
+				Page page{};
+				page.size = std::max(page_size_, block.size);
+				page.handle = create_page_buffer(page.size);
+				new_pages.push_back(std::move(page));
+				offset = 0;
+			}
+
+			copy_block_(pages_[block.page].handle, new_pages.back().handle, block.offset, offset, block.size, bound_src, bound_dst);
+			block.page = static_cast<u32>(new_pages.size() - 1);
+			block.offset = offset;
+			cursor = offset + block.size;
+
+			// The tail behind the last packed block is the only free range of the page.
+			Page& page = new_pages.back();
+			page.free_ranges.clear();
+			if (cursor < page.size) {
+				page.free_ranges.push_back(Range{ cursor, page.size - cursor });
+			}
+		}
+
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		for (auto& page : pages_) {
+			detail::destroy_buffer_(page.handle);
+		}
+		pages_ = std::move(new_pages);
+	}
+}
@@ -2,11 +2,18 @@
 
 #include "MiniRHI/Buffer.hpp"
 #include "MiniRHI/Format.hpp"
+#include "MiniRHI/MiniRHI.hpp"
 #include "MiniRHI/PipelineState.hpp"
 #include "MiniRHI/RC.hpp"
+#include "MiniRHI/Stats.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <limits>
 #include <unordered_map>
+#include <vector>
 #include <cassert>
 
 #include <Core/Core.hpp>
@@ -14,8 +21,6 @@
 #include <glm/gtc/type_ptr.hpp> 
 
 namespace minirhi {
-	extern u32 gDefaultVAO;
-
 	static GLenum convert_topology_type(PrimitiveTopologyType type) noexcept {
 		switch (type) {
 		case PrimitiveTopologyType::ePoint: return GL_POINTS;
@@ -25,6 +30,18 @@ namespace minirhi {
 		}
 	}
 
+	static GLenum convert_index_type(IndexType type) noexcept {
+		switch (type) {
+		case IndexType::eUInt16: return GL_UNSIGNED_SHORT;
+		case IndexType::eUInt32: return GL_UNSIGNED_INT;
+		}
+		return GL_UNSIGNED_INT;
+	}
+
+	static size_t get_index_size(IndexType type) noexcept {
+		return type == IndexType::eUInt16 ? sizeof(u16) : sizeof(u32);
+	}
+
 	static GLenum convert_polygon_mode(PolygonMode mode) noexcept {
 		switch (mode) {
 #ifndef ANDROID
@@ -67,56 +84,254 @@ namespace minirhi {
 		return GL_LESS;
 	}
 
-	u32 CmdCtx::create_vao_() noexcept {
-		return gDefaultVAO;
+	// Shadow copy of the GL state last applied through MiniRHI.
+	// Pipeline setup diffs against it and only issues the calls whose values actually change.
+	struct GLStateCache {
+		static constexpr u32 kMaxTextureUnits = 16;
+		static constexpr u32 kMaxUniformBufferBindings = 24;
+
+		detail::GraphicsPipelineRaw pipeline;
+		Viewport viewport;
+		u32 vao = detail::kInvalidVAHandle;
+		u32 indirect_buffer = kBufferInvalidHandle;
+		u32 framebuffer = kFramebufferInvalidHandle;
+		u32 active_texture_unit = std::numeric_limits<u32>::max();
+		std::array<u32, kMaxTextureUnits> textures = make_invalid_textures();
+		std::array<UniformBufferRange, kMaxUniformBufferBindings> uniform_buffers{};
+		bool valid = false;
+
+		static constexpr std::array<u32, kMaxTextureUnits> make_invalid_textures() noexcept {
+			std::array<u32, kMaxTextureUnits> ret{};
+			ret.fill(kInvalidTextureHandle);
+			return ret;
+		}
+	};
+
+	static GLStateCache gStateCache{};
+
+	// Last values uploaded to every uniform location of a program, stored as raw words.
+	// The epoch is bumped on every upload that actually reached GL.
+	struct UniformShadow {
+		struct Value {
+			std::array<u32, 16> words{};
+			u32 word_count = 0;
+		};
+
+		std::vector<Value> values;
+		u64 epoch = 1;
+	};
+
+	static std::unordered_map<u32, UniformShadow> gUniformShadows;
+	static u32 gLastShadowProgram = kShaderInvalidHandle;
+	static UniformShadow* gLastShadow = nullptr;
+	// Highest epoch of a dropped shadow. GL reuses program names, a new shadow starts past it
+	// so a BindingSet applied to the deleted program can't match.
+	static u64 gRetiredShadowEpoch = 0;
+
+	static UniformShadow& get_uniform_shadow(u32 program) noexcept {
+		if (gLastShadow == nullptr || gLastShadowProgram != program) {
+			auto [it, inserted] = gUniformShadows.try_emplace(program);
+			if (inserted) {
+				it->second.epoch = gRetiredShadowEpoch + 1;
+			}
+			gLastShadow = &it->second;
+			gLastShadowProgram = program;
+		}
+		return *gLastShadow;
 	}
 
-	void CmdCtx::setup_pipeline_(u32 vao, std::span<const VtxAttrData> attribs, detail::GraphicsPipelineRaw pipeline, const Viewport& vp) noexcept {
-		glViewport(GLint(vp.x), GLint(vp.y), GLint(vp.width), GLint(vp.height));
-
-		if (bool(pipeline.state.enable_depth)) {
-			glEnable(GL_DEPTH_TEST);
-			glDepthMask(GLboolean(DepthMask(u32(pipeline.state.depth_mask)) == DepthMask::eAll));
-			glDepthFunc(convert_depth_func(DepthFunc(u32(pipeline.state.depth_fn))));
-		}
-
-		glBindVertexArray(vao);
-		std::size_t i = 0;
-		for (auto[format, size, offset, stride] : attribs) {
-			glVertexAttribPointer(
-				i, 
-				GLint(get_component_count(format)),
-				get_format_type(format),
-				GL_FALSE,
-				GLsizei(stride),
-				std::bit_cast<void*>(offset)
-			);
-			glEnableVertexAttribArray(i);
-			i++;
+	// Returns true if the value differs from the shadowed one and has to be uploaded.
+	static bool update_uniform_shadow(u32 program, i32 location, const void* data, u32 word_count) noexcept {
+		if (location < 0) {
+			return false;
 		}
 
-		glUseProgram(pipeline.state.program);
+		UniformShadow& shadow = get_uniform_shadow(program);
+		if (std::size_t(location) >= shadow.values.size()) {
+			shadow.values.resize(std::size_t(location) + 1);
+		}
+
+		UniformShadow::Value& value = shadow.values[std::size_t(location)];
+		if (value.word_count == word_count && std::memcmp(value.words.data(), data, word_count * sizeof(u32)) == 0) {
+			MINIRHI_STAT(redundant_state_calls, 1);
+			return false;
+		}
+
+		std::memcpy(value.words.data(), data, word_count * sizeof(u32));
+		value.word_count = word_count;
+		shadow.epoch++;
+		MINIRHI_STAT(uniform_uploads, 1);
+		return true;
+	}
+
+	// Depth mask/function are forced to GL defaults when depth test is off, 
+	// so clearing the depth buffer keeps working like it did with an explicit reset.
+	// Cull mode is don't-care while culling is disabled, so it inherits the shadowed value.
+	static detail::GraphicsPipelineRaw normalize_pipeline_state(detail::GraphicsPipelineRaw pipeline, const GLStateCache& cache) noexcept {
+		if (!bool(pipeline.state.enable_depth)) {
+			pipeline.state.depth_mask = u32(DepthMask::eAll);
+			pipeline.state.depth_fn = u32(DepthFunc::eLe);
+		}
+		if (!bool(pipeline.state.cull_mode_enabled)) {
+			pipeline.state.cull_mode = cache.valid ? cache.pipeline.state.cull_mode : u32(CullFaceMode::eBack);
+		}
+		pipeline.state.topology = 0;
+		pipeline.state.padding = 0;
+		return pipeline;
+	}
+
+	// VAOs are cached per vertex layout and buffer combination, so a draw only has to bind one.
+	struct VertexArrayKey {
+		const VtxAttrData* layout;
+		u32 vb;
+		u32 ib;
+		u32 instance_vb;
+
+		bool operator==(const VertexArrayKey&) const noexcept = default;
+	};
+
+	struct VertexArrayKeyHash {
+		std::size_t operator()(const VertexArrayKey& key) const noexcept {
+			std::size_t hash = std::hash<const VtxAttrData*>{}(key.layout);
+			hash ^= (std::size_t(key.vb) << 32u | std::size_t(key.ib)) + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u);
+			hash ^= std::size_t(key.instance_vb) + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u);
+			return hash;
+		}
+	};
+
+	static std::unordered_map<VertexArrayKey, u32, VertexArrayKeyHash> gVertexArrays;
+
+	void CmdCtx::invalidate_state_cache() noexcept {
+		gStateCache.valid = false;
+		gStateCache.vao = detail::kInvalidVAHandle;
+		gStateCache.indirect_buffer = kBufferInvalidHandle;
+		gStateCache.framebuffer = kFramebufferInvalidHandle;
+		gStateCache.active_texture_unit = std::numeric_limits<u32>::max();
+		gStateCache.textures = GLStateCache::make_invalid_textures();
+		gStateCache.uniform_buffers = {};
+
+		// Epochs keep growing, so a BindingSet applied before the reset can't be mistaken for the current state.
+		for (auto& [program, shadow] : gUniformShadows) {
+			shadow.values.clear();
+			shadow.epoch++;
+		}
+	}
+
+	void CmdCtx::setup_pipeline_(detail::GraphicsPipelineRaw pipeline, const Viewport& vp) noexcept {
+		GLStateCache& cache = gStateCache;
+		const detail::GraphicsPipelineRaw next = normalize_pipeline_state(pipeline, cache);
+		const auto& cur = cache.pipeline.state;
+		const bool force = !cache.valid;
+
+		if (force || cur.enable_depth != next.state.enable_depth) {
+			detail::set_depth_test_impl_(bool(next.state.enable_depth));
+		}
+		if (force || cur.depth_mask != next.state.depth_mask) {
+			detail::set_depth_mask_impl_(DepthMask(u32(next.state.depth_mask)));
+		}
+		if (force || cur.depth_fn != next.state.depth_fn) {
+			detail::set_depth_func_impl_(DepthFunc(u32(next.state.depth_fn)));
+		}
 		
-		if (bool(pipeline.state.cull_mode_enabled)) {
-			glEnable(GL_CULL_FACE);
-			glCullFace(convert_cull_mode(CullFaceMode(u32(pipeline.state.cull_mode))));
-		} else {
-			glDisable(GL_CULL_FACE);
+		if (force || cur.cull_mode_enabled != next.state.cull_mode_enabled) {
+			detail::set_cull_face_enabled_impl_(bool(next.state.cull_mode_enabled));
+		}
+		if (force || cur.cull_mode != next.state.cull_mode) {
+			detail::set_cull_face_impl_(CullFaceMode(u32(next.state.cull_mode)));
+		}
+		if (force || cur.front_face != next.state.front_face) {
+			detail::set_front_face_impl_(FrontFace(u32(next.state.front_face)));
 		}
-		glFrontFace(convert_front_face(FrontFace(u32(pipeline.state.front_face))));
 
-#ifndef ANDROID
-		glPolygonMode(GL_FRONT_AND_BACK, convert_polygon_mode(PolygonMode(u32(pipeline.state.polygon_mode))));
-		if (bool(pipeline.state.line_smooth_enabled)) {
-			glEnable(GL_LINE_SMOOTH);
-		} else {
-			glDisable(GL_LINE_SMOOTH);
+		if (force || cur.polygon_mode != next.state.polygon_mode) {
+			detail::set_polygon_mode_impl_(PolygonMode(u32(next.state.polygon_mode)));
 		}
-#endif
+		if (force || cur.line_smooth_enabled != next.state.line_smooth_enabled) {
+			detail::set_line_smooth_impl_(bool(next.state.line_smooth_enabled));
+		}
+
+		finish_transition_(pipeline, vp);
+	}
+
+	bool CmdCtx::is_current_state_(detail::GraphicsPipelineRaw pipeline) noexcept {
+		const GLStateCache& cache = gStateCache;
+		if (!cache.valid) {
+			return false;
+		}
+		detail::GraphicsPipelineRaw expected = normalize_pipeline_state(pipeline, cache);
+		expected.state.program = cache.pipeline.state.program;
+		return expected.dummy_ == cache.pipeline.dummy_;
 	}
 
+	void CmdCtx::finish_transition_(detail::GraphicsPipelineRaw pipeline, const Viewport& vp) noexcept {
+		GLStateCache& cache = gStateCache;
+		const detail::GraphicsPipelineRaw next = normalize_pipeline_state(pipeline, cache);
+		const bool force = !cache.valid;
+
+		if (force || cache.viewport.x != vp.x || cache.viewport.y != vp.y || cache.viewport.width != vp.width || cache.viewport.height != vp.height) {
+			glViewport(GLint(vp.x), GLint(vp.y), GLint(vp.width), GLint(vp.height));
+			cache.viewport = vp;
+		}
+		if (force || cache.pipeline.state.program != next.state.program) {
+			glUseProgram(next.state.program);
+			MINIRHI_STAT(program_switches, 1);
+		} else {
+			MINIRHI_STAT(redundant_state_calls, 1);
+		}
+
+		cache.pipeline = next;
+		cache.valid = true;
+	}
 
 	namespace detail {
+		void set_depth_test_impl_(bool enable) noexcept {
+			if (enable) {
+				glEnable(GL_DEPTH_TEST);
+			} else {
+				glDisable(GL_DEPTH_TEST);
+			}
+		}
+
+		void set_depth_mask_impl_(DepthMask mask) noexcept {
+			glDepthMask(GLboolean(mask == DepthMask::eAll));
+		}
+
+		void set_depth_func_impl_(DepthFunc func) noexcept {
+			glDepthFunc(convert_depth_func(func));
+		}
+
+		void set_cull_face_enabled_impl_(bool enable) noexcept {
+			if (enable) {
+				glEnable(GL_CULL_FACE);
+			} else {
+				glDisable(GL_CULL_FACE);
+			}
+		}
+
+		void set_cull_face_impl_(CullFaceMode mode) noexcept {
+			glCullFace(convert_cull_mode(mode));
+		}
+
+		void set_front_face_impl_(FrontFace front) noexcept {
+			glFrontFace(convert_front_face(front));
+		}
+
+		void set_polygon_mode_impl_([[maybe_unused]] PolygonMode mode) noexcept {
+#ifndef ANDROID
+			glPolygonMode(GL_FRONT_AND_BACK, convert_polygon_mode(mode));
+#endif
+		}
+
+		void set_line_smooth_impl_([[maybe_unused]] bool enable) noexcept {
+#ifndef ANDROID
+			if (enable) {
+				glEnable(GL_LINE_SMOOTH);
+			} else {
+				glDisable(GL_LINE_SMOOTH);
+			}
+#endif
+		}
+
 		void clear_color_buffer_impl_(f32 r, f32 g, f32 b, f32 a) noexcept {
 			glClearColor(r, g, b, a);
 			glClear(GL_COLOR_BUFFER_BIT);
@@ -130,62 +345,289 @@ namespace minirhi {
 			glClear(GL_STENCIL_BUFFER_BIT);
 		}
 
-		void unset_pipeline_impl_() noexcept {
-			glBindVertexArray(0);
+		void bind_vertex_input_(std::span<const VtxAttrData> attribs, u32 vb, u32 ib, u32 instance_vb) noexcept {
+			GLStateCache& cache = gStateCache;
+			const VertexArrayKey key{ attribs.data(), vb, ib, instance_vb };
+
+			if (auto it = gVertexArrays.find(key); it != gVertexArrays.end()) {
+				if (cache.vao != it->second) {
+					glBindVertexArray(it->second);
+					cache.vao = it->second;
+					MINIRHI_STAT(vao_binds, 1);
+				} else {
+					MINIRHI_STAT(redundant_state_calls, 1);
+				}
+				return;
+			}
+
+			u32 vao = 0;
+			glGenVertexArrays(1, &vao);
+			glBindVertexArray(vao);
+			cache.vao = vao;
+			MINIRHI_STAT(vao_binds, 1);
+
+			u32 bound_vb = 0;
+			u32 i = 0;
+			for (auto[format, size, offset, stride, step_rate] : attribs) {
+				const u32 source = step_rate == 0 ? vb : instance_vb;
+				assert(source != 0 && "Per-instance attributes require an instance buffer!");
+				if (source != bound_vb) {
+					glBindBuffer(GL_ARRAY_BUFFER, source);
+					bound_vb = source;
+				}
+
+				glVertexAttribPointer(
+					i, 
+					GLint(get_component_count(format)),
+					get_format_type(format),
+					GL_FALSE,
+					GLsizei(stride),
+					std::bit_cast<void*>(offset)
+				);
+				glEnableVertexAttribArray(i);
+				if (step_rate != 0) {
+					glVertexAttribDivisor(i, step_rate);
+				}
+				i++;
+			}
+			if (ib != 0) {
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib);
+			}
+
+			gVertexArrays.emplace(key, vao);
+		}
 
-			glDisable(GL_CULL_FACE);
-			glFrontFace(GL_CCW);
+		void evict_buffer_bindings_(u32 buffer) noexcept {
+			if (gStateCache.indirect_buffer == buffer) {
+				gStateCache.indirect_buffer = kBufferInvalidHandle;
+			}
+			for (auto& range : gStateCache.uniform_buffers) {
+				if (range.handle == buffer) {
+					range = UniformBufferRange{};
+				}
+			}
+			for (auto it = gVertexArrays.begin(); it != gVertexArrays.end();) {
+				if (it->first.vb != buffer && it->first.ib != buffer && it->first.instance_vb != buffer) {
+					++it;
+					continue;
+				}
+				if (gStateCache.vao == it->second) {
+					gStateCache.vao = kInvalidVAHandle;
+				}
+				glDeleteVertexArrays(1, &it->second);
+				it = gVertexArrays.erase(it);
+			}
+		}
 
-			glLineWidth(1.0);
-	#ifndef ANDROID
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			glDisable(GL_LINE_SMOOTH);
-	#endif
+		void draw_impl_(PrimitiveTopologyType topology, size_t vertex_count, size_t offset) noexcept {
+			glDrawArrays(convert_topology_type(topology), GLint(offset), GLsizei(vertex_count));
+			MINIRHI_STAT(draw_calls, 1);
+			MINIRHI_STAT(vertices, vertex_count);
+		}
 
-			glDepthFunc(GL_LESS);
-			glDepthMask(GL_TRUE);
-			glDisable(GL_DEPTH_TEST);
+		void draw_indexed_impl_(PrimitiveTopologyType topology, IndexType index_type, size_t index_count, size_t offset) noexcept {
+			glDrawElements(convert_topology_type(topology), GLsizei(index_count), convert_index_type(index_type), std::bit_cast<void*>(offset));
+			MINIRHI_STAT(draw_calls, 1);
+			MINIRHI_STAT(indices, index_count);
 		}
-	
-		void draw_impl_(PrimitiveTopologyType topology, u32 vb, size_t vertex_count, size_t offset) noexcept {
-			glBindBuffer(GL_ARRAY_BUFFER, vb);
-			glDrawArrays(convert_topology_type(topology), GLint(offset), GLsizei(vertex_count));
+		void draw_indexed_base_vertex_impl_(PrimitiveTopologyType topology, IndexType index_type, size_t index_count, size_t first_index, i32 base_vertex) noexcept {
+			glDrawElementsBaseVertex(
+				convert_topology_type(topology), 
+				GLsizei(index_count), 
+				convert_index_type(index_type), 
+				std::bit_cast<void*>(first_index * get_index_size(index_type)), 
+				base_vertex
+			);
+			MINIRHI_STAT(draw_calls, 1);
+			MINIRHI_STAT(indices, index_count);
 		}
 
-		void draw_indexed_impl_(PrimitiveTopologyType topology, u32 vb, u32 ib, size_t index_count, size_t offset) noexcept {
-			glBindBuffer(GL_ARRAY_BUFFER, vb);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib);
-			glDrawElements(convert_topology_type(topology), GLsizei(index_count), GL_UNSIGNED_INT, std::bit_cast<void*>(offset));
+
+		void draw_instanced_impl_(PrimitiveTopologyType topology, size_t vertex_count, size_t instance_count, size_t offset) noexcept {
+			glDrawArraysInstanced(convert_topology_type(topology), GLint(offset), GLsizei(vertex_count), GLsizei(instance_count));
+			MINIRHI_STAT(draw_calls, 1);
+			MINIRHI_STAT(vertices, vertex_count * instance_count);
 		}
 
-		void set_texture2d_binding_impl_(u32 bound_texture_count, u32 program, std::string_view name, u32 texture) noexcept {
-			glUniform1i(glGetUniformLocation(program, name.data()), GLint(bound_texture_count));
-			glActiveTexture(GL_TEXTURE0 + bound_texture_count);
+		void draw_indexed_instanced_impl_(PrimitiveTopologyType topology, IndexType index_type, size_t index_count, size_t instance_count, size_t offset) noexcept {
+			glDrawElementsInstanced(convert_topology_type(topology), GLsizei(index_count), convert_index_type(index_type), std::bit_cast<void*>(offset), GLsizei(instance_count));
+			MINIRHI_STAT(draw_calls, 1);
+			MINIRHI_STAT(indices, index_count * instance_count);
+		}
+		void multi_draw_indexed_indirect_impl_(PrimitiveTopologyType topology, IndexType index_type, u32 indirect_buffer, size_t draw_count, size_t first_command) noexcept {
+			const GLenum mode = convert_topology_type(topology);
+			const GLenum type = convert_index_type(index_type);
+			const DeviceCaps& caps = get_device_caps();
+			constexpr size_t kStride = sizeof(DrawIndexedIndirectCommand);
+			MINIRHI_STAT(draw_calls, draw_count);
+
+			if (caps.draw_indirect) {
+				if (gStateCache.indirect_buffer != indirect_buffer) {
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+					gStateCache.indirect_buffer = indirect_buffer;
+				}
+#ifndef ANDROID
+				if (caps.multi_draw_indirect) {
+					glMultiDrawElementsIndirect(mode, type, std::bit_cast<void*>(first_command * kStride), GLsizei(draw_count), 0);
+					return;
+				}
+#endif
+				for (size_t i = 0; i < draw_count; i++) {
+					glDrawElementsIndirect(mode, type, std::bit_cast<void*>((first_command + i) * kStride));
+				}
+				return;
+			}
+
+			// No indirect draws at all: read the commands back and issue them from the CPU.
+			// Base instance can't be honored here, it requires GL 4.2.
+			glBindBuffer(GL_COPY_READ_BUFFER, indirect_buffer);
+			const auto* commands = static_cast<const DrawIndexedIndirectCommand*>(
+				glMapBufferRange(GL_COPY_READ_BUFFER, GLintptr(first_command * kStride), GLsizeiptr(draw_count * kStride), GL_MAP_READ_BIT)
+			);
+			if (commands == nullptr) {
+				glBindBuffer(GL_COPY_READ_BUFFER, 0);
+				return;
+			}
+			for (size_t i = 0; i < draw_count; i++) {
+				const DrawIndexedIndirectCommand& cmd = commands[i];
+				glDrawElementsInstancedBaseVertex(
+					mode, 
+					GLsizei(cmd.index_count), 
+					type, 
+					std::bit_cast<void*>(size_t(cmd.first_index) * get_index_size(index_type)), 
+					GLsizei(cmd.instance_count), 
+					cmd.base_vertex
+				);
+			}
+			glUnmapBuffer(GL_COPY_READ_BUFFER);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+
+		void bind_texture2d_impl_(u32 unit, u32 texture) noexcept {
+			GLStateCache& cache = gStateCache;
+			if (unit < GLStateCache::kMaxTextureUnits && cache.textures[unit] == texture) {
+				MINIRHI_STAT(redundant_state_calls, 1);
+				return;
+			}
+			if (cache.active_texture_unit != unit) {
+				glActiveTexture(GL_TEXTURE0 + unit);
+				cache.active_texture_unit = unit;
+			}
 			glBindTexture(GL_TEXTURE_2D, texture);
+			MINIRHI_STAT(texture_binds, 1);
+			if (unit < GLStateCache::kMaxTextureUnits) {
+				cache.textures[unit] = texture;
+			}
+		}
+
+		void bind_uniform_buffer_impl_(u32 binding, const UniformBufferRange& range) noexcept {
+			GLStateCache& cache = gStateCache;
+			assert(binding < GLStateCache::kMaxUniformBufferBindings);
+			auto& bound = cache.uniform_buffers[binding];
+			if (bound.handle == range.handle && bound.offset == range.offset && bound.size == range.size) {
+				MINIRHI_STAT(redundant_state_calls, 1);
+				return;
+			}
+			glBindBufferRange(GL_UNIFORM_BUFFER, binding, range.handle, GLintptr(range.offset), GLsizeiptr(range.size));
+			bound = range;
+		}
+
+		void invalidate_texture_bindings_() noexcept {
+			gStateCache.textures = GLStateCache::make_invalid_textures();
+		}
+
+		void bind_framebuffer_impl_(u32 framebuffer) noexcept {
+			if (gStateCache.framebuffer != framebuffer) {
+				glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+				gStateCache.framebuffer = framebuffer;
+			} else {
+				MINIRHI_STAT(redundant_state_calls, 1);
+			}
+		}
+
+		// Keeps the pipeline shadow in sync, a disabled depth test is normalised to a full mask anyway.
+		void enable_depth_writes_() noexcept {
+			GLStateCache& cache = gStateCache;
+			if (!cache.valid || DepthMask(u32(cache.pipeline.state.depth_mask)) != DepthMask::eAll) {
+				set_depth_mask_impl_(DepthMask::eAll);
+				cache.pipeline.state.depth_mask = u32(DepthMask::eAll);
+			}
 		}
 
-		void set_uint_binding_impl_(u32 program, std::string_view name, u32 value) noexcept {
-			glProgramUniform1ui(program, glGetUniformLocation(program, name.data()), value);
+		void invalidate_framebuffer_binding_() noexcept {
+			gStateCache.framebuffer = kFramebufferInvalidHandle;
 		}
 
-		void set_float_binding_impl_(u32 program, std::string_view name, f32 value) noexcept {
-			glProgramUniform1f(program, glGetUniformLocation(program, name.data()), value);
+		// Deleting the bound framebuffer reverts the binding to the default one.
+		void evict_framebuffer_binding_(u32 framebuffer) noexcept {
+			if (gStateCache.framebuffer == framebuffer) {
+				gStateCache.framebuffer = 0;
+			}
+		}
+
+		// A new program may get the deleted one's name, so the next draw has to call glUseProgram again.
+		void evict_program_(u32 program) noexcept {
+			if (gStateCache.pipeline.state.program == program) {
+				gStateCache.pipeline.state.program = kShaderInvalidHandle;
+			}
+			if (gLastShadowProgram == program) {
+				gLastShadow = nullptr;
+				gLastShadowProgram = kShaderInvalidHandle;
+			}
+			if (auto it = gUniformShadows.find(program); it != gUniformShadows.end()) {
+				gRetiredShadowEpoch = std::max(gRetiredShadowEpoch, it->second.epoch);
+				gUniformShadows.erase(it);
+			}
+		}
+
+		void evict_texture_bindings_(u32 texture) noexcept {
+			for (u32& bound : gStateCache.textures) {
+				if (bound == texture) {
+					bound = kInvalidTextureHandle;
+				}
+			}
+		}
+
+		void set_sampler_binding_impl_(u32 program, i32 location, u32 unit) noexcept {
+			const auto value = GLint(unit);
+			if (update_uniform_shadow(program, location, &value, 1)) {
+				glProgramUniform1i(program, location, value);
+			}
+		}
+
+		void set_uint_binding_impl_(u32 program, i32 location, u32 value) noexcept {
+			if (update_uniform_shadow(program, location, &value, 1)) {
+				glProgramUniform1ui(program, location, value);
+			}
+		}
+
+		void set_float_binding_impl_(u32 program, i32 location, f32 value) noexcept {
+			if (update_uniform_shadow(program, location, &value, 1)) {
+				glProgramUniform1f(program, location, value);
+			}
 		}	
 
-		void set_mat4_binding_impl_(u32 program, std::string_view name, const glm::mat4& value) noexcept {
-			glUniformMatrix4fv(glGetUniformLocation(program, name.data()), 1, GL_FALSE, glm::value_ptr(value));
+		void set_mat4_binding_impl_(u32 program, i32 location, const glm::mat4& value) noexcept {
+			static_assert(sizeof(glm::mat4) == 16 * sizeof(u32));
+			if (update_uniform_shadow(program, location, glm::value_ptr(value), 16)) {
+				glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+			}
+		}
+
+		u64 get_uniform_epoch_(u32 program) noexcept {
+			return get_uniform_shadow(program).epoch;
 		}
 
-		// TODO: sync
-		static bool gContextBorrowed = false;
+		// Atomic, so that a draw context started from a recording thread by mistake is caught instead of racing.
+		static std::atomic<bool> gContextBorrowed = false;
 
 		void release_context_() noexcept {
-			gContextBorrowed = false;
+			gContextBorrowed.store(false, std::memory_order_release);
 		}
 
 		void borrow_context_() noexcept {
-			assert(!gContextBorrowed && "The context is busy! Release the context before starting new one!");
-			gContextBorrowed = true;
+			[[maybe_unused]] const bool was_borrowed = gContextBorrowed.exchange(true, std::memory_order_acquire);
+			assert(!was_borrowed && "The context is busy! Release the context before starting new one!");
 		}
 	}
 }
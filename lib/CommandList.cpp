@@ -0,0 +1,168 @@
+#include "MiniRHI/CommandList.hpp"
+
+namespace minirhi {
+	template<typename Cmd>
+	[[nodiscard]]
+	static Cmd read_command(const std::byte* data) noexcept {
+		Cmd cmd;
+		std::memcpy(&cmd, data, sizeof(Cmd));
+		return cmd;
+	}
+
+	std::byte* CommandList::allocate_(std::size_t size) noexcept {
+		assert(size <= kChunkSize);
+		if (chunks_.empty()) {
+			chunks_.push_back(Chunk{ std::make_unique<std::byte[]>(kChunkSize), 0 });
+		}
+		if (chunks_[current_chunk_].used + size > kChunkSize) {
+			current_chunk_++;
+			if (current_chunk_ == chunks_.size()) {
+				chunks_.push_back(Chunk{ std::make_unique<std::byte[]>(kChunkSize), 0 });
+			}
+			chunks_[current_chunk_].used = 0;
+		}
+
+		Chunk& chunk = chunks_[current_chunk_];
+		std::byte* ptr = chunk.data.get() + chunk.used;
+		chunk.used += size;
+		return ptr;
+	}
+
+	void CommandList::reset() noexcept {
+		for (auto& chunk : chunks_) {
+			chunk.used = 0;
+		}
+		current_chunk_ = 0;
+		command_count_ = 0;
+	}
+
+	void CommandList::submit() const noexcept {
+		detail::borrow_context_();
+		replay_();
+		detail::release_context_();
+	}
+
+	void CommandList::replay_range_(Mark begin, Mark end) const noexcept {
+		using namespace detail::cmd;
+
+		for (std::size_t c = begin.chunk; c < chunks_.size() && c <= end.chunk; c++) {
+			const Chunk& chunk = chunks_[c];
+			const std::size_t stop = c == end.chunk ? end.offset : chunk.used;
+			for (std::size_t offset = c == begin.chunk ? begin.offset : 0; offset < stop;) {
+				const std::byte* ptr = chunk.data.get() + offset;
+				const auto header = read_command<Header>(ptr);
+				const std::byte* data = ptr + align_(sizeof(Header));
+				offset += header.size;
+
+				switch (header.type) {
+				case Type::eSetPipeline: {
+					const auto cmd = read_command<SetPipeline>(data);
+					CmdCtx::setup_pipeline_(cmd.pipeline, cmd.viewport);
+					break;
+				}
+				case Type::eClearColor: {
+					const auto cmd = read_command<ClearColor>(data);
+					detail::clear_color_buffer_impl_(cmd.r, cmd.g, cmd.b, cmd.a);
+					break;
+				}
+				case Type::eClearDepth: 
+					detail::clear_depth_buffer_impl_();
+					break;
+				case Type::eClearStencil: 
+					detail::clear_stencil_buffer_impl_();
+					break;
+				case Type::eBindVertexInput: {
+					const auto cmd = read_command<BindVertexInput>(data);
+					detail::bind_vertex_input_(std::span(cmd.attribs, cmd.attrib_count), cmd.vb, cmd.ib, cmd.instance_vb);
+					break;
+				}
+				case Type::eBindTexture: {
+					const auto cmd = read_command<BindTexture>(data);
+					detail::bind_texture2d_impl_(cmd.unit, cmd.texture);
+					break;
+				}
+				case Type::eSetSampler: {
+					const auto cmd = read_command<SetSampler>(data);
+					detail::set_sampler_binding_impl_(cmd.program, cmd.location, cmd.unit);
+					break;
+				}
+				case Type::eSetUInt: {
+					const auto cmd = read_command<SetUInt>(data);
+					detail::set_uint_binding_impl_(cmd.program, cmd.location, cmd.value);
+					break;
+				}
+				case Type::eSetFloat: {
+					const auto cmd = read_command<SetFloat>(data);
+					detail::set_float_binding_impl_(cmd.program, cmd.location, cmd.value);
+					break;
+				}
+				case Type::eSetMat4: {
+					const auto cmd = read_command<SetMat4>(data);
+					detail::set_mat4_binding_impl_(cmd.program, cmd.location, cmd.value);
+					break;
+				}
+				case Type::eBindUniformBuffer: {
+					const auto cmd = read_command<BindUniformBuffer>(data);
+					detail::bind_uniform_buffer_impl_(cmd.binding, cmd.range);
+					break;
+				}
+				case Type::eDraw: {
+					const auto cmd = read_command<Draw>(data);
+					detail::draw_impl_(cmd.topology, cmd.vertex_count, cmd.offset);
+					break;
+				}
+				case Type::eDrawIndexed: {
+					const auto cmd = read_command<DrawIndexed>(data);
+					detail::draw_indexed_impl_(cmd.topology, cmd.index_type, cmd.index_count, cmd.offset);
+					break;
+				}
+				case Type::eDrawIndexedBaseVertex: {
+					const auto cmd = read_command<DrawIndexedBaseVertex>(data);
+					detail::draw_indexed_base_vertex_impl_(cmd.topology, cmd.index_type, cmd.index_count, cmd.first_index, cmd.base_vertex);
+					break;
+				}
+				case Type::eDrawInstanced: {
+					const auto cmd = read_command<DrawInstanced>(data);
+					detail::draw_instanced_impl_(cmd.topology, cmd.vertex_count, cmd.instance_count, cmd.offset);
+					break;
+				}
+				case Type::eDrawIndexedInstanced: {
+					const auto cmd = read_command<DrawIndexedInstanced>(data);
+					detail::draw_indexed_instanced_impl_(cmd.topology, cmd.index_type, cmd.index_count, cmd.instance_count, cmd.offset);
+					break;
+				}
+				case Type::eMultiDrawIndexedIndirect: {
+					const auto cmd = read_command<MultiDrawIndexedIndirect>(data);
+					detail::multi_draw_indexed_indirect_impl_(cmd.topology, cmd.index_type, cmd.indirect_buffer, cmd.draw_count, cmd.first_command);
+					break;
+				}
+				default:
+					assert(false && "Unknown command type.");
+					break;
+				}
+			}
+		}
+	}
+
+	void ParallelCommandList::submit() const noexcept {
+		detail::borrow_context_();
+		for (const auto& job : lists_) {
+			job.list.replay_();
+		}
+		detail::release_context_();
+	}
+
+	void ParallelCommandList::reset() noexcept {
+		for (auto& job : lists_) {
+			job.list.reset();
+		}
+	}
+
+	std::size_t ParallelCommandList::command_count() const noexcept {
+		std::size_t count = 0;
+		for (const auto& job : lists_) {
+			count += job.list.command_count();
+		}
+		return count;
+	}
+}
@@ -0,0 +1,156 @@
+#include "MiniRHI/DeletionQueue.hpp"
+#include "MiniRHI/MpscQueue.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <atomic>
+#include <span>
+#include <utility>
+
+namespace minirhi {
+	namespace detail {
+		void evict_buffer_bindings_(u32 buffer) noexcept;
+		void evict_texture_bindings_(u32 texture) noexcept;
+		void evict_framebuffer_binding_(u32 framebuffer) noexcept;
+	}
+
+	namespace {
+		MpscQueue<PendingDeletion> gIncoming;
+		std::atomic<bool> gDeferring{ false };
+
+		void delete_now_(std::span<const PendingDeletion> deletions) noexcept {
+			static std::vector<u32> buffers;
+			static std::vector<u32> textures;
+			static std::vector<u32> framebuffers;
+
+			for (const auto& deletion : deletions) {
+				switch (deletion.kind) {
+				case DeletionKind::eBuffer:
+					detail::evict_buffer_bindings_(deletion.handle);
+					buffers.push_back(deletion.handle);
+					break;
+				case DeletionKind::eTexture:
+					detail::evict_texture_bindings_(deletion.handle);
+					textures.push_back(deletion.handle);
+					break;
+				case DeletionKind::eFramebuffer:
+					detail::evict_framebuffer_binding_(deletion.handle);
+					framebuffers.push_back(deletion.handle);
+					break;
+				}
+			}
+
+			if (!buffers.empty()) {
+				glDeleteBuffers(GLsizei(buffers.size()), buffers.data());
+				buffers.clear();
+			}
+			if (!textures.empty()) {
+				glDeleteTextures(GLsizei(textures.size()), textures.data());
+				textures.clear();
+			}
+			if (!framebuffers.empty()) {
+				glDeleteFramebuffers(GLsizei(framebuffers.size()), framebuffers.data());
+				framebuffers.clear();
+			}
+		}
+	}
+
+	namespace detail {
+		bool defer_deletion_(DeletionKind kind, u32 handle) noexcept {
+			if (!gDeferring.load(std::memory_order_acquire)) {
+				return false;
+			}
+			gIncoming.push(PendingDeletion{ handle, kind });
+			return true;
+		}
+
+		bool is_deferring_deletions_() noexcept {
+			return gDeferring.load(std::memory_order_acquire);
+		}
+	}
+
+	DeletionQueue::DeletionQueue(DeletionQueue&& rhs) noexcept
+		: batches_(std::move(rhs.batches_))
+		, active_(std::exchange(rhs.active_, false))
+	{}
+
+	DeletionQueue& DeletionQueue::operator=(DeletionQueue&& rhs) noexcept {
+		if (this == &rhs) {
+			return *this;
+		}
+
+		release_();
+		batches_ = std::move(rhs.batches_);
+		active_ = std::exchange(rhs.active_, false);
+
+		return *this;
+	}
+
+	DeletionQueue::~DeletionQueue() noexcept {
+		release_();
+	}
+
+	void DeletionQueue::release_() noexcept {
+		if (!active_) {
+			assert(batches_.empty());
+			return;
+		}
+
+		// Handles pushed by other threads after this point are leaked, stop them before tearing down.
+		gDeferring.store(false, std::memory_order_release);
+		submit();
+		collect(true);
+		active_ = false;
+	}
+
+	void DeletionQueue::activate() noexcept {
+		[[maybe_unused]] const bool was_deferring = gDeferring.exchange(true, std::memory_order_acq_rel);
+		assert(!was_deferring && "Only one DeletionQueue can be active!");
+		active_ = true;
+	}
+
+	void DeletionQueue::submit() noexcept {
+		assert(active_);
+
+		Batch batch{};
+		PendingDeletion deletion{};
+		while (gIncoming.try_pop(deletion)) {
+			batch.deletions.push_back(deletion);
+		}
+		if (batch.deletions.empty()) {
+			return;
+		}
+
+		batch.fence = Fence::insert();
+		batches_.push_back(std::move(batch));
+	}
+
+	void DeletionQueue::collect(bool wait) noexcept {
+		// Fences signal in submission order, the first pending batch ends the scan.
+		std::size_t retired = 0;
+		for (; retired < batches_.size(); retired++) {
+			Batch& batch = batches_[retired];
+			if (wait) {
+				batch.fence.wait();
+			} else if (!batch.fence.is_signaled()) {
+				break;
+			}
+
+			delete_now_(batch.deletions);
+			Fence::destroy(batch.fence);
+		}
+		batches_.erase(batches_.begin(), batches_.begin() + std::ptrdiff_t(retired));
+	}
+
+	std::size_t DeletionQueue::get_pending_count() const noexcept {
+		std::size_t count = 0;
+		for (const auto& batch : batches_) {
+			count += batch.deletions.size();
+		}
+		return count;
+	}
+}
@@ -0,0 +1,40 @@
+#include "MiniRHI/Fence.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <bit>
+
+namespace minirhi {
+	Fence Fence::insert() noexcept {
+		return Fence{ std::bit_cast<void*>(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) };
+	}
+
+	void Fence::destroy(Fence& fence) noexcept {
+		if (fence.sync != nullptr) {
+			glDeleteSync(std::bit_cast<GLsync>(fence.sync));
+			fence.sync = nullptr;
+		}
+	}
+
+	bool Fence::is_signaled() const noexcept {
+		if (sync == nullptr) {
+			return true;
+		}
+		GLint status = GL_UNSIGNALED;
+		glGetSynciv(std::bit_cast<GLsync>(sync), GL_SYNC_STATUS, 1, nullptr, &status);
+		return status == GL_SIGNALED;
+	}
+
+	bool Fence::wait(u64 timeout_ns) const noexcept {
+		if (sync == nullptr) {
+			return true;
+		}
+		// The first wait flushes, so the fence is guaranteed to be reached eventually.
+		const GLenum result = glClientWaitSync(std::bit_cast<GLsync>(sync), GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+		return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+	}
+}
@@ -36,8 +36,21 @@ namespace minirhi
 		case Format::eRG32_UInt:
 		case Format::eRGB32_UInt:
 		case Format::eRGBA32_UInt:
+		case Format::eD24_UNorm:
 			return GL_UNSIGNED_INT;
 
+		case Format::eD16_UNorm:
+			return GL_UNSIGNED_SHORT;
+
+		case Format::eD32_Float:
+			return GL_FLOAT;
+
+		case Format::eD24_UNorm_S8_UInt:
+			return GL_UNSIGNED_INT_24_8;
+
+		case Format::eD32_Float_S8_UInt:
+			return GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
+
 		default:
 			return 0;
 		}
@@ -72,12 +85,33 @@ namespace minirhi
 		case Format::eRGBA16_UInt:
 		case Format::eRGBA32_UInt:
 			return GL_RGBA;
+
+		[[fallthrough]]; case Format::eD16_UNorm:
+		case Format::eD24_UNorm:
+		case Format::eD32_Float:
+			return GL_DEPTH_COMPONENT;
+
+		[[fallthrough]]; case Format::eD24_UNorm_S8_UInt:
+		case Format::eD32_Float_S8_UInt:
+			return GL_DEPTH_STENCIL;
 		
 		default:
 			return 0;
 		}
 	}
 
+	u32 get_internal_format(Format format) noexcept {
+		switch (format) {
+		case Format::eD16_UNorm: return GL_DEPTH_COMPONENT16;
+		case Format::eD24_UNorm: return GL_DEPTH_COMPONENT24;
+		case Format::eD32_Float: return GL_DEPTH_COMPONENT32F;
+		case Format::eD24_UNorm_S8_UInt: return GL_DEPTH24_STENCIL8;
+		case Format::eD32_Float_S8_UInt: return GL_DEPTH32F_STENCIL8;
+		default:
+			return get_pixel_format(format);
+		}
+	}
+
 	u32 get_component_count(Format format) noexcept {
 		switch (format) {
 		[[fallthrough]]; case Format::eR16_Float:
@@ -85,6 +119,9 @@ namespace minirhi
 		case Format::eR8_UInt:
 		case Format::eR16_UInt:
 		case Format::eR32_UInt:
+		case Format::eD16_UNorm:
+		case Format::eD24_UNorm:
+		case Format::eD32_Float:
 			return 1;
 
 		[[fallthrough]]; case Format::eRG16_Float:
@@ -92,6 +129,8 @@ namespace minirhi
 		case Format::eRG8_UInt:
 		case Format::eRG16_UInt:
 		case Format::eRG32_UInt:
+		case Format::eD24_UNorm_S8_UInt:
+		case Format::eD32_Float_S8_UInt:
 			return 2;
 
 		[[fallthrough]]; case Format::eRGB16_Float:
@@ -120,6 +159,7 @@ namespace minirhi
 
 		[[fallthrough]]; case Format::eR16_Float:
 		case Format::eR16_UInt:
+		case Format::eD16_UNorm:
 			return 2;
 
 		case Format::eRGB8_UInt:
@@ -130,6 +170,9 @@ namespace minirhi
 		case Format::eR32_Float:
 		case Format::eRG16_UInt:
 		case Format::eR32_UInt:
+		case Format::eD24_UNorm:
+		case Format::eD32_Float:
+		case Format::eD24_UNorm_S8_UInt:
 			return 4;
 
 		[[fallthrough]]; case Format::eRGB16_Float:
@@ -140,6 +183,7 @@ namespace minirhi
 		case Format::eRG32_Float:
 		case Format::eRGBA16_UInt:
 		case Format::eRG32_UInt:
+		case Format::eD32_Float_S8_UInt:
 			return 8;
 		
 		[[fallthrough]]; case Format::eRGB32_Float:
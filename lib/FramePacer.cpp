@@ -0,0 +1,110 @@
+#include "MiniRHI/FramePacer.hpp"
+#include "MiniRHI/Trace.hpp"
+
+#include <utility>
+
+namespace minirhi {
+	namespace {
+		f64 to_milliseconds_(std::chrono::steady_clock::duration duration) noexcept {
+			return std::chrono::duration<f64, std::milli>(duration).count();
+		}
+	}
+
+	FramePacer::FramePacer(u32 frames_in_flight) noexcept
+		: frames_in_flight_(frames_in_flight)
+	{
+		assert(frames_in_flight > 0 && frames_in_flight <= kMaxFramesInFlight);
+		deletions_.activate();
+	}
+
+	FramePacer::FramePacer(FramePacer&& rhs) noexcept
+		: fences_(std::exchange(rhs.fences_, {}))
+		, deletions_(std::move(rhs.deletions_))
+		, frames_in_flight_(std::exchange(rhs.frames_in_flight_, 0))
+		, slot_(rhs.slot_)
+		, frame_index_(rhs.frame_index_)
+		, in_frame_(std::exchange(rhs.in_frame_, false))
+		, frame_begin_(rhs.frame_begin_)
+		, timing_(rhs.timing_)
+		, last_timing_(rhs.last_timing_)
+	{}
+
+	FramePacer& FramePacer::operator=(FramePacer&& rhs) noexcept {
+		if (this == &rhs) {
+			return *this;
+		}
+
+		release_();
+		fences_ = std::exchange(rhs.fences_, {});
+		deletions_ = std::move(rhs.deletions_);
+		frames_in_flight_ = std::exchange(rhs.frames_in_flight_, 0);
+		slot_ = rhs.slot_;
+		frame_index_ = rhs.frame_index_;
+		in_frame_ = std::exchange(rhs.in_frame_, false);
+		frame_begin_ = rhs.frame_begin_;
+		timing_ = rhs.timing_;
+		last_timing_ = rhs.last_timing_;
+
+		return *this;
+	}
+
+	FramePacer::~FramePacer() noexcept {
+		release_();
+	}
+
+	void FramePacer::release_() noexcept {
+		// Resources of the frames in flight may still be in use, wait_idle() destroys the fences as well.
+		wait_idle();
+	}
+
+	void FramePacer::begin_frame() noexcept {
+		assert(frames_in_flight_ > 0 && !in_frame_ && "begin_frame() and end_frame() have to alternate!");
+
+		const Clock::time_point wait_begin = Clock::now();
+		{
+			MINIRHI_TRACE_SCOPE("FramePacer::wait");
+			fences_[slot_].wait();
+		}
+		Fence::destroy(fences_[slot_]);
+		deletions_.collect();
+
+		const Clock::time_point now = Clock::now();
+		timing_.wait_ms = to_milliseconds_(now - wait_begin);
+		timing_.frame_ms = frame_index_ == 0 ? 0.0 : to_milliseconds_(now - frame_begin_);
+		frame_begin_ = now;
+		in_frame_ = true;
+	}
+
+	void FramePacer::end_frame() noexcept {
+		assert(in_frame_ && "begin_frame() and end_frame() have to alternate!");
+
+		// Submitted first, so the frame's fence signaling implies the batch's did.
+		deletions_.submit();
+		fences_[slot_] = Fence::insert();
+		timing_.cpu_ms = to_milliseconds_(Clock::now() - frame_begin_);
+		last_timing_ = timing_;
+
+		slot_ = (slot_ + 1) % frames_in_flight_;
+		frame_index_++;
+		in_frame_ = false;
+	}
+
+	void FramePacer::wait_idle() noexcept {
+		for (auto& fence : fences_) {
+			fence.wait();
+			Fence::destroy(fence);
+		}
+		if (deletions_.is_active()) {
+			deletions_.collect(true);
+		}
+	}
+
+	void FramePacer::set_frames_in_flight(u32 frames_in_flight) noexcept {
+		assert(frames_in_flight > 0 && frames_in_flight <= kMaxFramesInFlight);
+		assert(!in_frame_ && "Frames in flight can only change between frames!");
+
+		wait_idle();
+		frames_in_flight_ = frames_in_flight;
+		slot_ = 0;
+	}
+}
@@ -0,0 +1,62 @@
+#include "MiniRHI/Framebuffer.hpp"
+#include "MiniRHI/DeletionQueue.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+namespace minirhi {
+	namespace detail {
+		void evict_framebuffer_binding_(u32 framebuffer) noexcept;
+		void invalidate_framebuffer_binding_() noexcept;
+
+		u32 create_framebuffer_impl_(const FramebufferDesc& desc) noexcept {
+			u32 handle = 0;
+			glGenFramebuffers(1, &handle);
+			glBindFramebuffer(GL_FRAMEBUFFER, handle);
+
+			std::array<GLenum, kMaxColorAttachments> draw_buffers{};
+			for (u32 i = 0; i < desc.color_attachment_count; i++) {
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GLenum(GL_COLOR_ATTACHMENT0 + i), GL_TEXTURE_2D, desc.color_attachments[i], 0);
+				draw_buffers[i] = GLenum(GL_COLOR_ATTACHMENT0 + i);
+			}
+			if (desc.color_attachment_count != 0) {
+				glDrawBuffers(GLsizei(desc.color_attachment_count), draw_buffers.data());
+			} else {
+				// Depth-only, otherwise the framebuffer is incomplete on GL < 4.1
+				const GLenum none = GL_NONE;
+				glDrawBuffers(1, &none);
+				glReadBuffer(GL_NONE);
+			}
+
+			if (desc.depth_stencil_attachment != kInvalidTextureHandle) {
+				const GLenum attachment = has_stencil(desc.depth_stencil_format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+				glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, desc.depth_stencil_attachment, 0);
+			}
+
+			const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			invalidate_framebuffer_binding_();
+
+			assert(status == GL_FRAMEBUFFER_COMPLETE && "Framebuffer is incomplete!");
+			if (status != GL_FRAMEBUFFER_COMPLETE) {
+				glDeleteFramebuffers(1, &handle);
+				return kFramebufferInvalidHandle;
+			}
+			return handle;
+		}
+	}
+
+	void Framebuffer::destroy(Framebuffer& fb) noexcept {
+		if (fb.handle == kFramebufferInvalidHandle) {
+			return;
+		}
+		if (!detail::defer_deletion_(DeletionKind::eFramebuffer, fb.handle)) {
+			detail::evict_framebuffer_binding_(fb.handle);
+			glDeleteFramebuffers(1, &fb.handle);
+		}
+		fb.handle = kFramebufferInvalidHandle;
+	}
+}
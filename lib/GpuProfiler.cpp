@@ -0,0 +1,163 @@
+#include "MiniRHI/GpuProfiler.hpp"
+#include "MiniRHI/MiniRHI.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace minirhi {
+	GpuProfiler::GpuProfiler(u32 frame_latency) noexcept {
+		assert(frame_latency > 0 && frame_latency <= kMaxFrames);
+		if (get_device_caps().timer_query) {
+			frame_count_ = frame_latency + 1;
+		}
+	}
+
+	GpuProfiler::GpuProfiler(GpuProfiler&& rhs) noexcept
+		: frames_(std::exchange(rhs.frames_, {}))
+		, frame_count_(std::exchange(rhs.frame_count_, 0))
+		, frame_(rhs.frame_)
+		, frame_index_(rhs.frame_index_)
+		, depth_(rhs.depth_)
+		, free_queries_(std::move(rhs.free_queries_))
+		, results_(std::move(rhs.results_))
+		, timings_(std::move(rhs.timings_))
+		, results_frame_(rhs.results_frame_)
+		, dropped_frames_(rhs.dropped_frames_)
+	{}
+
+	GpuProfiler& GpuProfiler::operator=(GpuProfiler&& rhs) noexcept {
+		if (this == &rhs) {
+			return *this;
+		}
+
+		release_();
+		frames_ = std::exchange(rhs.frames_, {});
+		frame_count_ = std::exchange(rhs.frame_count_, 0);
+		frame_ = rhs.frame_;
+		frame_index_ = rhs.frame_index_;
+		depth_ = rhs.depth_;
+		free_queries_ = std::move(rhs.free_queries_);
+		results_ = std::move(rhs.results_);
+		timings_ = std::move(rhs.timings_);
+		results_frame_ = rhs.results_frame_;
+		dropped_frames_ = rhs.dropped_frames_;
+
+		return *this;
+	}
+
+	GpuProfiler::~GpuProfiler() noexcept {
+		release_();
+	}
+
+	void GpuProfiler::release_() noexcept {
+		for (auto& frame : frames_) {
+			for (const auto& scope : frame.scopes) {
+				free_queries_.push_back(scope.begin_query);
+				free_queries_.push_back(scope.end_query);
+			}
+			frame.scopes.clear();
+		}
+		if (!free_queries_.empty()) {
+			glDeleteQueries(GLsizei(free_queries_.size()), free_queries_.data());
+			free_queries_.clear();
+		}
+	}
+
+	u32 GpuProfiler::acquire_query_() noexcept {
+		if (free_queries_.empty()) {
+			u32 query = 0;
+			glGenQueries(1, &query);
+			return query;
+		}
+		const u32 query = free_queries_.back();
+		free_queries_.pop_back();
+		return query;
+	}
+
+	u32 GpuProfiler::begin_scope(std::string_view name) noexcept {
+		if (!is_enabled()) {
+			return kInvalidScope;
+		}
+
+		Frame& frame = frames_[frame_];
+		ScopeRecord record{ name, acquire_query_(), acquire_query_(), depth_++ };
+#ifndef ANDROID
+		glQueryCounter(record.begin_query, GL_TIMESTAMP);
+#endif
+		frame.scopes.push_back(record);
+		return u32(frame.scopes.size() - 1);
+	}
+
+	void GpuProfiler::end_scope(u32 scope) noexcept {
+		if (scope == kInvalidScope) {
+			return;
+		}
+
+		assert(depth_ > 0 && scope < frames_[frame_].scopes.size() && "GPU scopes must not outlive the frame they were opened in!");
+		depth_--;
+#ifndef ANDROID
+		glQueryCounter(frames_[frame_].scopes[scope].end_query, GL_TIMESTAMP);
+#endif
+	}
+
+	void GpuProfiler::next_frame() noexcept {
+		if (!is_enabled()) {
+			return;
+		}
+
+		assert(depth_ == 0 && "Every GPU scope has to be closed before the next frame!");
+		frames_[frame_].index = frame_index_++;
+		// The next slot holds the frame issued frame_latency frames ago, resolve it before reusing the slot.
+		frame_ = (frame_ + 1) % frame_count_;
+		resolve_(frames_[frame_]);
+	}
+
+	void GpuProfiler::resolve_(Frame& frame) noexcept {
+		if (frame.scopes.empty()) {
+			return;
+		}
+
+#ifndef ANDROID
+		// Queries complete in order, the last one being available means the whole frame is.
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(frame.scopes.back().end_query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available == GL_TRUE) {
+			results_.clear();
+			timings_.clear();
+			results_frame_ = frame.index;
+			for (const auto& scope : frame.scopes) {
+				GLuint64 begin = 0;
+				GLuint64 end = 0;
+				glGetQueryObjectui64v(scope.begin_query, GL_QUERY_RESULT, &begin);
+				glGetQueryObjectui64v(scope.end_query, GL_QUERY_RESULT, &end);
+				const f64 milliseconds = f64(end - begin) / 1'000'000.0;
+				timings_.push_back(GpuScopeTiming{ scope.name, begin, end, scope.depth });
+
+				auto it = std::ranges::find(results_, scope.name, &GpuScopeResult::name);
+				if (it == results_.end()) {
+					results_.push_back(GpuScopeResult{ scope.name, milliseconds, 1, scope.depth });
+				} else {
+					it->milliseconds += milliseconds;
+					it->count++;
+				}
+			}
+		} else {
+			dropped_frames_++;
+		}
+#endif
+
+		for (const auto& scope : frame.scopes) {
+			free_queries_.push_back(scope.begin_query);
+			free_queries_.push_back(scope.end_query);
+		}
+		frame.scopes.clear();
+	}
+}
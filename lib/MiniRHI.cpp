@@ -1,15 +1,31 @@
 #include "MiniRHI/MiniRHI.hpp"
 #include <Core/Core.hpp>
-#include <limits>
 
 namespace minirhi {
-	u32 gDefaultVAO = std::numeric_limits<u32>::max();
+	static DeviceCaps gDeviceCaps{};
 
 	void init() {
 	#ifndef ANDROID
 		glewExperimental = true;
 		glewInit();
-		glGenVertexArrays(1, &gDefaultVAO);
+
+		gDeviceCaps.draw_indirect = GLEW_VERSION_4_0 || GLEW_ARB_draw_indirect;
+		gDeviceCaps.multi_draw_indirect = GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+		gDeviceCaps.buffer_storage = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+		gDeviceCaps.invalidate_framebuffer = GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata;
+		gDeviceCaps.timer_query = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+	#else
+		// GLES 3.1 and up
+		gDeviceCaps.draw_indirect = true;
+		gDeviceCaps.multi_draw_indirect = false;
+		gDeviceCaps.buffer_storage = false;
+		gDeviceCaps.invalidate_framebuffer = true;
+		// Only available through EXT_disjoint_timer_query
+		gDeviceCaps.timer_query = false;
 	#endif
 	}
+
+	const DeviceCaps& get_device_caps() noexcept {
+		return gDeviceCaps;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "MiniRHI/ReadbackRing.hpp"
+#include "MiniRHI/CmdCtx.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <utility>
+
+namespace minirhi {
+	ReadbackRing::ReadbackRing(u32 slot_count) noexcept
+		: slots_(slot_count)
+	{
+		assert(slot_count > 0);
+		for (auto& slot : slots_) {
+			glGenBuffers(1, &slot.buffer);
+		}
+	}
+
+	ReadbackRing::ReadbackRing(ReadbackRing&& rhs) noexcept
+		: slots_(std::exchange(rhs.slots_, {}))
+		, next_slot_(rhs.next_slot_)
+		, serial_(rhs.serial_)
+	{}
+
+	ReadbackRing& ReadbackRing::operator=(ReadbackRing&& rhs) noexcept {
+		if (this == &rhs) {
+			return *this;
+		}
+
+		release_();
+		slots_ = std::exchange(rhs.slots_, {});
+		next_slot_ = rhs.next_slot_;
+		serial_ = rhs.serial_;
+
+		return *this;
+	}
+
+	ReadbackRing::~ReadbackRing() noexcept {
+		release_();
+	}
+
+	void ReadbackRing::release_() noexcept {
+		for (auto& slot : slots_) {
+			if (slot.state == SlotState::eMapped) {
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			Fence::destroy(slot.fence);
+			glDeleteBuffers(1, &slot.buffer);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		slots_.clear();
+	}
+
+	ReadbackRequest ReadbackRing::read_(u32 framebuffer, const ReadbackRect& rect, Format format, u32 attachment) noexcept {
+		assert(framebuffer != kFramebufferInvalidHandle);
+
+		// Slots are handed out round robin, so the oldest read is the first one that gets reused.
+		Slot* slot = nullptr;
+		for (u32 i = 0; i < slots_.size() && slot == nullptr; i++) {
+			const u32 index = (next_slot_ + i) % u32(slots_.size());
+			if (slots_[index].state == SlotState::eFree) {
+				slot = &slots_[index];
+				next_slot_ = (index + 1) % u32(slots_.size());
+			}
+		}
+		if (slot == nullptr) {
+			return ReadbackRequest{};
+		}
+
+		slot->size = std::size_t(rect.width) * rect.height * get_format_size(format);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+		if (slot->capacity < slot->size) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(slot->size), nullptr, GL_STREAM_READ);
+			slot->capacity = slot->size;
+		}
+
+		detail::borrow_context_();
+		detail::bind_framebuffer_impl_(framebuffer);
+		if (!is_depth_format(format)) {
+			glReadBuffer(framebuffer == 0 ? GL_BACK : GLenum(GL_COLOR_ATTACHMENT0 + attachment));
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(
+			GLint(rect.x),
+			GLint(rect.y),
+			GLsizei(rect.width),
+			GLsizei(rect.height),
+			GLenum(get_pixel_format(format)),
+			GLenum(get_format_type(format)),
+			nullptr
+		);
+		detail::release_context_();
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		Fence::destroy(slot->fence);
+		slot->fence = Fence::insert();
+		// Headless renderers may never swap, polling the fence only works once it has been submitted.
+		glFlush();
+		slot->state = SlotState::ePending;
+		slot->serial = ++serial_;
+
+		return ReadbackRequest{ u32(slot - slots_.data()), slot->serial };
+	}
+
+	std::size_t ReadbackRing::find_slot_(const ReadbackRequest& request) const noexcept {
+		if (!request.is_valid() || request.slot >= slots_.size()) {
+			return slots_.size();
+		}
+		const Slot& slot = slots_[request.slot];
+		if (slot.serial != request.serial || slot.state == SlotState::eFree) {
+			return slots_.size();
+		}
+		return request.slot;
+	}
+
+	bool ReadbackRing::is_ready(const ReadbackRequest& request) const noexcept {
+		const std::size_t index = find_slot_(request);
+		if (index == slots_.size()) {
+			return false;
+		}
+		return slots_[index].state == SlotState::eMapped || slots_[index].fence.is_signaled();
+	}
+
+	std::span<const u8> ReadbackRing::map(const ReadbackRequest& request) noexcept {
+		const std::size_t index = find_slot_(request);
+		assert(index != slots_.size() && "Stale or invalid readback request!");
+		if (index == slots_.size()) {
+			return {};
+		}
+		Slot* slot = &slots_[index];
+		if (slot->state == SlotState::eMapped) {
+			return std::span(slot->mapped, slot->size);
+		}
+
+		slot->fence.wait();
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+		slot->mapped = static_cast<const u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(slot->size), GL_MAP_READ_BIT));
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		if (slot->mapped == nullptr) {
+			return {};
+		}
+		slot->state = SlotState::eMapped;
+		return std::span(slot->mapped, slot->size);
+	}
+
+	void ReadbackRing::release(ReadbackRequest& request) noexcept {
+		const std::size_t index = find_slot_(request);
+		request = ReadbackRequest{};
+		if (index == slots_.size()) {
+			return;
+		}
+		Slot* slot = &slots_[index];
+
+		if (slot->state == SlotState::eMapped) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			slot->mapped = nullptr;
+		}
+		Fence::destroy(slot->fence);
+		slot->state = SlotState::eFree;
+	}
+}
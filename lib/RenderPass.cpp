@@ -0,0 +1,126 @@
+#include "MiniRHI/RenderPass.hpp"
+#include "MiniRHI/MiniRHI.hpp"
+
+namespace minirhi {
+	namespace detail {
+		void enable_depth_writes_() noexcept;
+	}
+
+	// Attachment enums differ between the default framebuffer and framebuffer objects.
+	struct InvalidateList {
+		std::array<GLenum, kMaxColorAttachments + 2> attachments{};
+		GLsizei count = 0;
+		bool is_default = false;
+
+		void add_color(u32 index) noexcept {
+			attachments[count++] = is_default ? GL_COLOR : GLenum(GL_COLOR_ATTACHMENT0 + index);
+		}
+
+		void add_depth() noexcept {
+			attachments[count++] = is_default ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+		}
+
+		void add_stencil() noexcept {
+			attachments[count++] = is_default ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+		}
+
+		void invalidate() const noexcept {
+			if (count != 0 && get_device_caps().invalidate_framebuffer) {
+				glInvalidateFramebuffer(GL_FRAMEBUFFER, count, attachments.data());
+			}
+		}
+	};
+
+	void RenderPass::begin_() noexcept {
+		detail::borrow_context_();
+		detail::bind_framebuffer_impl_(get_framebuffer_handle_());
+
+		InvalidateList dont_care{ .is_default = is_default_ };
+		GLbitfield mask = 0;
+
+		// A single glClearColor covers every attachment only if all of them are cleared to the same color.
+		u32 color_clear_count = 0;
+		bool same_clear_color = true;
+		for (u32 i = 0; i < color_count_; i++) {
+			const auto& ops = desc_.colors[i];
+			if (ops.load == LoadOp::eDontCare) {
+				dont_care.add_color(i);
+			}
+			if (ops.load == LoadOp::eClear) {
+				same_clear_color = same_clear_color && ops.clear_color == desc_.colors[0].clear_color;
+				color_clear_count++;
+			}
+		}
+		if (color_clear_count != 0 && color_clear_count == color_count_ && same_clear_color) {
+			const auto& color = desc_.colors[0].clear_color;
+			glClearColor(color[0], color[1], color[2], color[3]);
+			mask |= GL_COLOR_BUFFER_BIT;
+		} else if (color_clear_count != 0) {
+			for (u32 i = 0; i < color_count_; i++) {
+				if (desc_.colors[i].load == LoadOp::eClear) {
+					glClearBufferfv(GL_COLOR, GLint(i), desc_.colors[i].clear_color.data());
+				}
+			}
+		}
+
+		const auto& ds = desc_.depth_stencil;
+		if (has_depth_) {
+			if (ds.depth_load == LoadOp::eDontCare) {
+				dont_care.add_depth();
+			}
+			if (ds.depth_load == LoadOp::eClear) {
+				// glClear respects the depth mask of the last pipeline
+				detail::enable_depth_writes_();
+#ifndef ANDROID
+				glClearDepth(GLdouble(ds.clear_depth));
+#else
+				glClearDepthf(ds.clear_depth);
+#endif
+				mask |= GL_DEPTH_BUFFER_BIT;
+			}
+		}
+		if (has_stencil_) {
+			if (ds.stencil_load == LoadOp::eDontCare) {
+				dont_care.add_stencil();
+			}
+			if (ds.stencil_load == LoadOp::eClear) {
+				glClearStencil(GLint(ds.clear_stencil));
+				mask |= GL_STENCIL_BUFFER_BIT;
+			}
+		}
+
+		dont_care.invalidate();
+		if (mask != 0) {
+			glClear(mask);
+		}
+		detail::release_context_();
+	}
+
+	void RenderPass::end() noexcept {
+		if (!is_active_) {
+			return;
+		}
+		is_active_ = false;
+
+		InvalidateList discard{ .is_default = is_default_ };
+		for (u32 i = 0; i < color_count_; i++) {
+			if (desc_.colors[i].store == StoreOp::eDiscard) {
+				discard.add_color(i);
+			}
+		}
+		if (has_depth_ && desc_.depth_stencil.depth_store == StoreOp::eDiscard) {
+			discard.add_depth();
+		}
+		if (has_stencil_ && desc_.depth_stencil.stencil_store == StoreOp::eDiscard) {
+			discard.add_stencil();
+		}
+		if (discard.count == 0) {
+			return;
+		}
+
+		detail::borrow_context_();
+		detail::bind_framebuffer_impl_(get_framebuffer_handle_());
+		discard.invalidate();
+		detail::release_context_();
+	}
+}
@@ -0,0 +1,71 @@
+#include "MiniRHI/RenderQueue.hpp"
+
+namespace minirhi {
+	void RenderQueue::close_item_() noexcept {
+		if (has_open_item_) {
+			items_.back().end = list_.mark_();
+			has_open_item_ = false;
+			is_sorted_ = false;
+		}
+	}
+
+	void RenderQueue::sort_() noexcept {
+		constexpr u32 kRadixBits = 8;
+		constexpr u32 kBucketCount = 1 << kRadixBits;
+
+		order_.resize(items_.size());
+		scratch_.resize(items_.size());
+		for (std::size_t i = 0; i < items_.size(); i++) {
+			order_[i] = SortEntry{ items_[i].key, u32(i) };
+		}
+
+		// LSD radix sort, stable so equal keys keep submission order.
+		for (u32 shift = 0; shift < 64; shift += kRadixBits) {
+			std::array<u32, kBucketCount> offsets{};
+			for (const auto& entry : order_) {
+				offsets[(entry.key >> shift) & (kBucketCount - 1)]++;
+			}
+			// Every key has the same digit, the pass wouldn't move anything
+			if (offsets[(order_[0].key >> shift) & (kBucketCount - 1)] == order_.size()) {
+				continue;
+			}
+
+			u32 sum = 0;
+			for (auto& offset : offsets) {
+				const u32 count = offset;
+				offset = sum;
+				sum += count;
+			}
+			for (const auto& entry : order_) {
+				scratch_[offsets[(entry.key >> shift) & (kBucketCount - 1)]++] = entry;
+			}
+			order_.swap(scratch_);
+		}
+		is_sorted_ = true;
+	}
+
+	void RenderQueue::submit() noexcept {
+		if (items_.empty()) {
+			return;
+		}
+		close_item_();
+		if (!is_sorted_) {
+			sort_();
+		}
+
+		detail::borrow_context_();
+		for (const auto& entry : order_) {
+			const Item& item = items_[entry.item];
+			list_.replay_range_(item.begin, item.end);
+		}
+		detail::release_context_();
+	}
+
+	void RenderQueue::reset() noexcept {
+		list_.reset();
+		items_.clear();
+		order_.clear();
+		has_open_item_ = false;
+		is_sorted_ = true;
+	}
+}
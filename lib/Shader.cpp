@@ -1,4 +1,5 @@
 #include "MiniRHI/Shader.hpp"
+#include "MiniRHI/Trace.hpp"
 #include <algorithm>
 
 #ifndef ANDROID
@@ -16,8 +17,11 @@
 
 namespace minirhi {
 	namespace detail {
+		void evict_program_(u32 program) noexcept;
+
 		[[nodiscard]]
 		static u32 compile_shader_internal_impl_(std::string_view code, u32 sh_type) noexcept {
+			MINIRHI_TRACE_SCOPE("compile_shader");
 			u32 shader = glCreateShader(GLenum(sh_type)); 
 			auto* code_ptr = std::bit_cast<const GLchar*>(code.data());
 			
@@ -52,9 +56,15 @@ namespace minirhi {
 		void destroy_shader_impl_(u32 shader) noexcept {
 			glDeleteShader(GLuint(shader));
 		}
+
+		void destroy_program_impl_(u32 program) noexcept {
+			evict_program_(program);
+			glDeleteProgram(GLuint(program));
+		}
 	}
 
 	u32 ShaderCompiler::link_shaders_span(std::span<u32> shaders) noexcept {
+		MINIRHI_TRACE_SCOPE("link_shaders");
 		u32 program = glCreateProgram();
 
 		for (u32 shader : shaders) {
@@ -78,4 +88,30 @@ namespace minirhi {
 		
 		return program;
 	}
+
+	void ShaderCompiler::get_uniform_locations(u32 program, std::span<const std::string_view> names, std::span<i32> locations) noexcept {
+		assert(names.size() == locations.size());
+		for (std::size_t i = 0; i < names.size(); i++) {
+			locations[i] = glGetUniformLocation(program, names[i].data());
+		}
+	}
+
+	void ShaderCompiler::get_uniform_block_bindings(u32 program, std::span<const std::string_view> names, std::span<const bool> is_block, std::span<i32> locations) noexcept {
+		assert(names.size() == is_block.size() && names.size() == locations.size());
+		u32 binding = 0;
+		for (std::size_t i = 0; i < names.size(); i++) {
+			if (!is_block[i]) {
+				continue;
+			}
+
+			const GLuint block_index = glGetUniformBlockIndex(program, names[i].data());
+			if (block_index == GL_INVALID_INDEX) {
+				locations[i] = -1;
+			} else {
+				glUniformBlockBinding(program, block_index, binding);
+				locations[i] = i32(binding);
+			}
+			binding++;
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "MiniRHI/StreamBuffer.hpp"
+#include "MiniRHI/Stats.hpp"
+#include "MiniRHI/MiniRHI.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <utility>
+
+namespace minirhi {
+	StreamBuffer::StreamBuffer(const StreamBufferDesc& desc) noexcept
+		: type_(desc.type)
+		, frame_size_(desc.frame_size)
+		, frame_count_(desc.frame_count)
+	{
+		assert(desc.frame_count > 0 && desc.frame_count <= kMaxFrames);
+		assert(desc.frame_size > 0);
+
+		const auto total_size = static_cast<GLsizeiptr>(frame_size_ * frame_count_);
+		glGenBuffers(1, &handle_);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, handle_);
+
+	#ifndef ANDROID
+		if (get_device_caps().buffer_storage) {
+			constexpr GLbitfield kFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_COPY_WRITE_BUFFER, total_size, nullptr, kFlags);
+			mapped_ = static_cast<u8*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total_size, kFlags));
+		}
+	#endif
+
+		if (mapped_ == nullptr) {
+			glBufferData(GL_COPY_WRITE_BUFFER, total_size, nullptr, GL_STREAM_DRAW);
+			staging_.resize(frame_size_);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	StreamBuffer::StreamBuffer(StreamBuffer&& rhs) noexcept
+		: handle_(std::exchange(rhs.handle_, kBufferInvalidHandle))
+		, type_(rhs.type_)
+		, mapped_(std::exchange(rhs.mapped_, nullptr))
+		, staging_(std::move(rhs.staging_))
+		, frame_size_(rhs.frame_size_)
+		, frame_count_(rhs.frame_count_)
+		, frame_(rhs.frame_)
+		, head_(rhs.head_)
+		, flushed_(rhs.flushed_)
+		, fences_(std::exchange(rhs.fences_, {}))
+	{}
+
+	StreamBuffer& StreamBuffer::operator=(StreamBuffer&& rhs) noexcept {
+		if (this == &rhs) {
+			return *this;
+		}
+
+		release_();
+		handle_ = std::exchange(rhs.handle_, kBufferInvalidHandle);
+		type_ = rhs.type_;
+		mapped_ = std::exchange(rhs.mapped_, nullptr);
+		staging_ = std::move(rhs.staging_);
+		frame_size_ = rhs.frame_size_;
+		frame_count_ = rhs.frame_count_;
+		frame_ = rhs.frame_;
+		head_ = rhs.head_;
+		flushed_ = rhs.flushed_;
+		fences_ = std::exchange(rhs.fences_, {});
+
+		return *this;
+	}
+
+	StreamBuffer::~StreamBuffer() noexcept {
+		release_();
+	}
+
+	void StreamBuffer::release_() noexcept {
+		for (auto& fence : fences_) {
+			Fence::destroy(fence);
+		}
+		if (handle_ == kBufferInvalidHandle) {
+			return;
+		}
+		if (mapped_ != nullptr) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, handle_);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			mapped_ = nullptr;
+		}
+		detail::destroy_buffer_(handle_);
+	}
+
+	StreamAllocation StreamBuffer::allocate(std::size_t size, std::size_t alignment) noexcept {
+		assert(handle_ != kBufferInvalidHandle && alignment > 0);
+
+		// Aligned relative to the start of the buffer, views turn offsets into element indices.
+		const std::size_t base = frame_ * frame_size_;
+		const std::size_t offset = (base + head_ + alignment - 1) / alignment * alignment;
+		if (offset + size > base + frame_size_) {
+			return StreamAllocation{};
+		}
+		head_ = offset + size - base;
+
+		u8* data = mapped_ != nullptr ? mapped_ + offset : staging_.data() + (offset - base);
+		return StreamAllocation{ data, handle_, offset, size };
+	}
+
+	void StreamBuffer::flush() noexcept {
+		if (flushed_ == head_) {
+			return;
+		}
+		MINIRHI_STAT(buffer_bytes_uploaded, head_ - flushed_);
+
+		// Persistent mappings are coherent, the range is only tracked for the stats.
+		if (mapped_ == nullptr) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, handle_);
+			glBufferSubData(
+				GL_COPY_WRITE_BUFFER, 
+				static_cast<GLintptr>(frame_ * frame_size_ + flushed_), 
+				static_cast<GLsizeiptr>(head_ - flushed_), 
+				staging_.data() + flushed_
+			);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		flushed_ = head_;
+	}
+
+	void StreamBuffer::next_frame() noexcept {
+		flush();
+
+		if (mapped_ != nullptr) {
+			Fence::destroy(fences_[frame_]);
+			fences_[frame_] = Fence::insert();
+		}
+
+		frame_ = (frame_ + 1) % frame_count_;
+		head_ = 0;
+		flushed_ = 0;
+
+		if (mapped_ != nullptr) {
+			fences_[frame_].wait();
+			Fence::destroy(fences_[frame_]);
+		} else if (frame_ == 0) {
+			// Orphan the storage, the driver keeps the old one alive until pending draws are done.
+			glBindBuffer(GL_COPY_WRITE_BUFFER, handle_);
+			glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(frame_size_ * frame_count_), nullptr, GL_STREAM_DRAW);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+	}
+}
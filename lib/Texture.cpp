@@ -1,4 +1,7 @@
 #include "MiniRHI/Texture.hpp"
+#include "MiniRHI/Stats.hpp"
+#include "MiniRHI/Trace.hpp"
+#include "MiniRHI/DeletionQueue.hpp"
 #include "MiniRHI/Format.hpp"
 #ifndef ANDROID
 #include <glew/glew.h>
@@ -48,7 +51,11 @@ namespace minirhi {
 	}
 
 	namespace detail {
+		void evict_texture_bindings_(u32 texture) noexcept;
+		void invalidate_texture_bindings_() noexcept;
+
 		u32 create_texture_impl_(const TextureDesc& desc, const SamplerDesc& sampler) noexcept {
+			MINIRHI_TRACE_SCOPE("create_texture");
 			u32 handle = 0;
 
 			glGenTextures(1, &handle);
@@ -68,44 +75,54 @@ namespace minirhi {
 #endif
 			glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, sampler.border_color.data());
 
-			if (desc.initial_data != nullptr) {
-				auto format = GLint(get_pixel_format(desc.pixel_format));
-				auto type = GLint(get_format_type(desc.pixel_format));
+			auto internal_format = GLint(get_internal_format(desc.pixel_format));
+			auto format = GLenum(get_pixel_format(desc.pixel_format));
+			auto type = GLenum(get_format_type(desc.pixel_format));
 
-				if (desc.extent == TextureExtent::e2D) {
+			// 2D textures always get storage, so ones without data can be used as render target attachments.
+			if (desc.extent == TextureExtent::e2D) {
 #ifndef _WIN32
-					glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-					glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-					glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-					glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+				glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+				glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
 #endif
 
-					glTexImage2D(
-						target, 
-						0, 
-						format, 
-						GLint(desc.size.width), 
-						GLint(desc.size.height), 
-						0, 
-						format, 
-						type, 
-						(const void*)desc.initial_data
-					);
+				glTexImage2D(
+					target, 
+					0, 
+					internal_format, 
+					GLint(desc.size.width), 
+					GLint(desc.size.height), 
+					0, 
+					format, 
+					type, 
+					(const void*)desc.initial_data
+				);
+				if (desc.initial_data != nullptr) {
+					MINIRHI_STAT(texture_bytes_uploaded, std::size_t(desc.size.width) * desc.size.height * get_format_size(desc.pixel_format));
 				}
+			}
 
-				if (desc.enable_mips) {
-					glGenerateMipmap(target);
-				}
+			if (desc.initial_data != nullptr && desc.enable_mips) {
+				glGenerateMipmap(target);
 			}
 
 			glBindTexture(target, 0);
+			invalidate_texture_bindings_();
 
 			return handle;
 		}
 	}
 
 	void Texture::destroy(Texture& tex) noexcept {
-		glDeleteTextures(1, &tex.handle);
+		if (tex.handle == kInvalidTextureHandle) {
+			return;
+		}
+		if (!detail::defer_deletion_(DeletionKind::eTexture, tex.handle)) {
+			detail::evict_texture_bindings_(tex.handle);
+			glDeleteTextures(1, &tex.handle);
+		}
 		tex.handle = kInvalidTextureHandle;
 	}
 }
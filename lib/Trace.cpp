@@ -0,0 +1,213 @@
+#include "MiniRHI/Trace.hpp"
+#include "MiniRHI/GpuProfiler.hpp"
+#include "MiniRHI/MiniRHI.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace minirhi::trace {
+	namespace {
+		constexpr u32 kCpuProcess = 1;
+		constexpr u32 kGpuProcess = 2;
+		// Events reserved by begin_capture(), a few frames worth
+		constexpr std::size_t kInitialEventCapacity = 4096;
+
+		struct Event {
+			std::string_view name;
+			u64 begin = 0;
+			u64 end = 0;
+			u32 process = kCpuProcess;
+			u32 thread = 0;
+		};
+
+		struct TraceState {
+			std::mutex mutex;
+			std::vector<Event> events;
+			std::size_t max_events = 0;
+			u64 dropped_events = 0;
+			// CPU tracks, in order of the first event recorded on each thread
+			std::vector<std::thread::id> threads;
+			// steady_clock ticks at begin_capture(), read by now() without the lock
+			std::atomic<std::chrono::steady_clock::rep> origin{ 0 };
+			// GL_TIMESTAMP at origin, 0 when the device has no timer queries
+			u64 gpu_origin = 0;
+			const GpuProfiler* gpu_profiler = nullptr;
+			u64 gpu_frame = 0;
+		};
+
+		TraceState gTrace;
+
+		u32 get_thread_track_() noexcept {
+			const auto id = std::this_thread::get_id();
+			for (u32 i = 0; i < gTrace.threads.size(); i++) {
+				if (gTrace.threads[i] == id) {
+					return i;
+				}
+			}
+			gTrace.threads.push_back(id);
+			return u32(gTrace.threads.size() - 1);
+		}
+
+		void push_event_(const Event& event) noexcept {
+			if (gTrace.events.size() >= gTrace.max_events) {
+				gTrace.dropped_events++;
+				return;
+			}
+			gTrace.events.push_back(event);
+		}
+
+		void write_string_(std::ostream& out, std::string_view str) noexcept {
+			out << '"';
+			for (const char c : str) {
+				if (c == '"' || c == '\\') {
+					out << '\\' << c;
+				} else if (u8(c) < 0x20) {
+					out << ' ';
+				} else {
+					out << c;
+				}
+			}
+			out << '"';
+		}
+
+		// Trace-event timestamps are microseconds, the fraction keeps nanosecond precision.
+		void write_microseconds_(std::ostream& out, u64 nanoseconds) noexcept {
+			const char fill = out.fill('0');
+			out << nanoseconds / 1000 << '.' << std::setw(3) << nanoseconds % 1000;
+			out.fill(fill);
+		}
+
+		void write_metadata_(std::ostream& out, std::string_view kind, u32 process, u32 thread, std::string_view name) noexcept {
+			out << "{\"name\":";
+			write_string_(out, kind);
+			out << ",\"ph\":\"M\",\"pid\":" << process << ",\"tid\":" << thread << ",\"args\":{\"name\":";
+			write_string_(out, name);
+			out << "}},\n";
+		}
+	}
+
+	void begin_capture(std::size_t max_events) noexcept {
+		std::lock_guard lock(gTrace.mutex);
+		// max_events is only a cap, reserving it up front would cost tens of MB per capture.
+		gTrace.events.clear();
+		gTrace.events.reserve(std::min(max_events, kInitialEventCapacity));
+		gTrace.max_events = max_events;
+		gTrace.dropped_events = 0;
+		gTrace.threads.clear();
+		gTrace.gpu_profiler = nullptr;
+		gTrace.gpu_frame = 0;
+		gTrace.gpu_origin = 0;
+
+		// The capturing thread is always the first track.
+		get_thread_track_();
+
+#ifndef ANDROID
+		if (get_device_caps().timer_query) {
+			GLint64 gpu_now = 0;
+			glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+			gTrace.gpu_origin = u64(gpu_now);
+		}
+#endif
+		gTrace.origin.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+		detail::gCapturing.store(true, std::memory_order_relaxed);
+	}
+
+	void end_capture() noexcept {
+		std::lock_guard lock(gTrace.mutex);
+		detail::gCapturing.store(false, std::memory_order_relaxed);
+	}
+
+	u64 now() noexcept {
+		using Clock = std::chrono::steady_clock;
+		const Clock::time_point origin{ Clock::duration(gTrace.origin.load(std::memory_order_relaxed)) };
+		return u64(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count());
+	}
+
+	void add_cpu_event(std::string_view name, u64 begin, u64 end) noexcept {
+		std::lock_guard lock(gTrace.mutex);
+		// Scopes that straddle begin_capture() belong to the previous capture.
+		if (!is_capturing() || begin > end) {
+			return;
+		}
+		push_event_(Event{ name, begin, end, kCpuProcess, get_thread_track_() });
+	}
+
+	void add_gpu_frame(const GpuProfiler& profiler) noexcept {
+		std::lock_guard lock(gTrace.mutex);
+		if (!is_capturing() || gTrace.gpu_origin == 0) {
+			return;
+		}
+
+		// A dropped frame leaves the previous results in place, don't record them twice.
+		if (gTrace.gpu_profiler == &profiler && gTrace.gpu_frame == profiler.get_results_frame()) {
+			return;
+		}
+		gTrace.gpu_profiler = &profiler;
+		gTrace.gpu_frame = profiler.get_results_frame();
+
+		for (const auto& timing : profiler.get_timings()) {
+			// Frames issued before the capture started
+			if (timing.begin < gTrace.gpu_origin || timing.end < timing.begin) {
+				continue;
+			}
+			push_event_(Event{ timing.name, timing.begin - gTrace.gpu_origin, timing.end - gTrace.gpu_origin, kGpuProcess, 0 });
+		}
+	}
+
+	u64 get_dropped_event_count() noexcept {
+		std::lock_guard lock(gTrace.mutex);
+		return gTrace.dropped_events;
+	}
+
+	bool write_chrome_trace(std::ostream& out) noexcept {
+		std::lock_guard lock(gTrace.mutex);
+
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		write_metadata_(out, "process_name", kCpuProcess, 0, "CPU");
+		write_metadata_(out, "process_name", kGpuProcess, 0, "GPU");
+		write_metadata_(out, "thread_name", kGpuProcess, 0, "GPU queue");
+		for (u32 i = 0; i < gTrace.threads.size(); i++) {
+			write_metadata_(out, "thread_name", kCpuProcess, i, i == 0 ? std::string("Capture thread") : "Thread " + std::to_string(i));
+		}
+
+		for (std::size_t i = 0; i < gTrace.events.size(); i++) {
+			const Event& event = gTrace.events[i];
+			out << "{\"name\":";
+			write_string_(out, event.name);
+			out << ",\"cat\":\"" << (event.process == kGpuProcess ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"ts\":";
+			write_microseconds_(out, event.begin);
+			out << ",\"dur\":";
+			write_microseconds_(out, event.end - event.begin);
+			out << ",\"pid\":" << event.process << ",\"tid\":" << event.thread << '}';
+			out << (i + 1 == gTrace.events.size() ? "\n" : ",\n");
+		}
+		if (gTrace.events.empty()) {
+			// Metadata entries end with a comma, close the array with an empty instant event.
+			out << "{\"name\":\"capture\",\"ph\":\"i\",\"ts\":0,\"pid\":" << kCpuProcess << ",\"tid\":0,\"s\":\"g\"}\n";
+		}
+		out << "]}\n";
+
+		return bool(out);
+	}
+
+	bool write_chrome_trace(const char* path) noexcept {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+		return write_chrome_trace(file);
+	}
+}
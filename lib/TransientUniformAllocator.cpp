@@ -0,0 +1,34 @@
+#include "MiniRHI/TransientUniformAllocator.hpp"
+#ifndef ANDROID
+#include <glew/glew.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES3/gl32.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace minirhi {
+	TransientUniformAllocator::TransientUniformAllocator(std::size_t frame_size, u32 frame_count) noexcept
+		: ring_(StreamBufferDesc{ .type = BufferType::eConstant, .frame_size = frame_size, .frame_count = frame_count })
+	{
+		GLint alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		alignment_ = static_cast<std::size_t>(std::max(alignment, 1));
+	}
+
+	UniformBufferRange TransientUniformAllocator::allocate(const void* data, std::size_t size) noexcept {
+		const StreamAllocation alloc = ring_.allocate(size, alignment_);
+		if (!alloc.is_valid()) {
+			return UniformBufferRange{};
+		}
+
+		std::memcpy(alloc.data, data, size);
+		// Without a persistent mapping the block has to reach GL before the draw that reads it.
+		if (!ring_.is_persistent()) {
+			ring_.flush();
+		}
+		return UniformBufferRange{ alloc.handle, alloc.offset, alloc.size };
+	}
+}
@@ -8,11 +8,11 @@
 #include "sdl/SDL_video.h"
 
 #include "MiniRHI/MiniRHI.hpp"
+#include "MiniRHI/Trace.hpp"
 #include "Core/Core.hpp"
 
 #include <iostream>
 #include <format>
-#include <chrono>
 
 i32 App::init() noexcept {
     SDL_LogSetAllPriority(SDL_LOG_PRIORITY_DEBUG);
@@ -39,35 +39,70 @@ i32 App::init() noexcept {
     surface_ = SDL_GetWindowSurface(window.ptr);
 
     minirhi::init();
+    frame_pacer_ = minirhi::FramePacer(kDefaultFramesInFlight);
     SDL_GL_SetSwapInterval(1);
     SDL_UpdateWindowSurface(window.ptr);
     return 0;
 }
 
 void App::run() noexcept {
-    using namespace std::chrono;
-
     bool quit = false;
     SDL_Event e;
     f32 delta = 16.6f;
     while(!quit) {
-        u64 start = SDL_GetTicks64();
-        while(SDL_PollEvent( &e ) != 0) { 
-            if(e.type == SDL_QUIT) {
-                quit = true;
-            } else {
-                this->dispatch_event(e);
+        MINIRHI_TRACE_SCOPE("frame");
+        frame_pacer_.begin_frame();
+        // The first frame has no predecessor to measure
+        if (frame_pacer_.get_frame_index() != 0) {
+            delta = f32(frame_pacer_.get_delta_ms());
+        }
+        {
+            MINIRHI_TRACE_SCOPE("events");
+            while(SDL_PollEvent( &e ) != 0) { 
+                if(e.type == SDL_QUIT) {
+                    quit = true;
+#ifdef MINIRHI_ENABLE_TRACING
+                } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F9) {
+                    toggle_trace_capture_();
+#endif
+                } else {
+                    this->dispatch_event(e);
+                }
             }
         }
-        this->update(delta);
-        this->render();
+        {
+            MINIRHI_TRACE_SCOPE("update");
+            this->update(delta);
+        }
+        {
+            MINIRHI_TRACE_SCOPE("render");
+            this->render();
+        }
+        {
+            MINIRHI_TRACE_SCOPE("swap");
+            SDL_GL_SwapWindow(window_);
+        }
+        frame_pacer_.end_frame();
+    }
+}
+
+void App::toggle_trace_capture_() noexcept {
+    if (!minirhi::trace::is_capturing()) {
+        minirhi::trace::begin_capture();
+        return;
+    }
 
-        SDL_GL_SwapWindow(window_);
-        delta = f32(SDL_GetTicks64() - start);
+    minirhi::trace::end_capture();
+    if (minirhi::trace::write_chrome_trace(kTracePath)) {
+        std::cout << std::format("Trace written to {}\n", kTracePath);
+    } else {
+        std::cerr << std::format("Couldn't write trace to {}!\n", kTracePath);
     }
 }
 
 App::~App() noexcept {
+    // The pacer's fences have to go before the context
+    frame_pacer_ = minirhi::FramePacer();
     SDL_GL_DeleteContext(gl_context_);
     SDL_DestroyWindow(window_);
     SDL_Quit();
@@ -2,6 +2,7 @@
 
 #include <string_view>
 #include "Core/Core.hpp"
+#include "MiniRHI/FramePacer.hpp"
 
 #include "sdl/SDL.h"
 #include "sdl/SDL_events.h"
@@ -12,6 +13,8 @@ protected:
     SDL_Window* window_ = nullptr;
     void* gl_context_ = nullptr;
     SDL_Surface* surface_ = nullptr;
+    // Bounds the frames queued on the GPU, subclasses can call set_frames_in_flight() after init().
+    minirhi::FramePacer frame_pacer_;
 
     std::string_view title_;
     u32 width_;
@@ -37,4 +40,11 @@ public:
     virtual void render() noexcept {}
     virtual void update(f32 delta) noexcept {}
     virtual void dispatch_event(SDL_Event event) noexcept {}
+
+private:
+    // F9 starts a capture, pressing it again writes the trace to kTracePath.
+    static constexpr const char* kTracePath = "minirhi_trace.json";
+    static constexpr u32 kDefaultFramesInFlight = 2;
+
+    void toggle_trace_capture_() noexcept;
 };
\ No newline at end of file